@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   block_codec.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Compression of the blocks of a weights container source file
+ */
+
+#include "block_codec.hpp"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace nntrainer {
+
+BlockCodec compressBlock(const char *src, std::size_t size, int level,
+                         bool huffman_only, std::vector<char> &dst) {
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, level, Z_DEFLATED, MAX_WBITS, MAX_MEM_LEVEL,
+                   huffman_only ? Z_HUFFMAN_ONLY : Z_DEFAULT_STRATEGY) != Z_OK)
+    throw std::runtime_error("deflate init failed");
+
+  dst.resize(deflateBound(&stream, static_cast<uLong>(size)));
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(src));
+  stream.avail_in = static_cast<uInt>(size);
+  stream.next_out = reinterpret_cast<Bytef *>(dst.data());
+  stream.avail_out = static_cast<uInt>(dst.size());
+  int ret = deflate(&stream, Z_FINISH);
+  std::size_t stored = stream.total_out;
+  deflateEnd(&stream);
+  if (ret != Z_STREAM_END)
+    throw std::runtime_error("deflate failed");
+
+  // incompressible blocks are stored as they are, loads read them straight
+  // into the slot
+  if (stored >= size) {
+    dst.assign(src, src + size);
+    return BlockCodec::NONE;
+  }
+  dst.resize(stored);
+  return BlockCodec::DEFLATE;
+}
+
+bool decompressBlock(const BlockInfo &block, const char *src, char *dst) {
+  if (block.codec == BlockCodec::NONE) {
+    std::memcpy(dst, src, block.size);
+    return true;
+  }
+
+  uLongf size = static_cast<uLongf>(block.size);
+  return uncompress(reinterpret_cast<Bytef *>(dst), &size,
+                    reinterpret_cast<const Bytef *>(src),
+                    static_cast<uLong>(block.stored_size)) == Z_OK &&
+         size == block.size;
+}
+} // namespace nntrainer
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   block_codec.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Compression of the blocks of a weights container header file
+ */
+
+#ifndef BLOCK_CODEC_HPP
+#define BLOCK_CODEC_HPP
+
+#pragma once
+#include "weights_container.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace nntrainer {
+
+/**
+ * @brief Compress a block with deflate
+ *
+ * @param src uncompressed block
+ * @param size size of the block
+ * @param level deflate level, 1 (fastest) to 9 (smallest)
+ * @param huffman_only skip the search for repeated strings and only entropy
+ * code the bytes. Packed int4 weights hardly repeat, so this keeps most of
+ * the gain at a fraction of the time
+ * @param dst receives the stored block
+ * @return BlockCodec DEFLATE, or NONE with a copy of src in dst when deflate
+ * does not make the block smaller
+ * @throws std::runtime_error if deflate fails
+ */
+BlockCodec compressBlock(const char *src, std::size_t size, int level,
+                         bool huffman_only, std::vector<char> &dst);
+
+/**
+ * @brief Restore a stored block
+ *
+ * @param block the block
+ * @param src stored bytes of the block, block.stored_size of them
+ * @param dst receives block.size uncompressed bytes
+ * @return true on success, false if the stored bytes are corrupt
+ */
+bool decompressBlock(const BlockInfo &block, const char *src, char *dst);
+} // namespace nntrainer
+
+#endif // BLOCK_CODEC_HPP
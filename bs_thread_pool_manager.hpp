@@ -16,14 +16,22 @@
 #pragma once
 #include "bs_thread_pool.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
 namespace nntrainer {
 /**
- * @brief ThreadPoolManager is a singleton class that manages a thread pool
+ * @brief ThreadPoolManager is a singleton class that manages a thread pool.
+ * The pool is built with BS::tp::priority, so queued tasks with a higher
+ * priority run first.
  *
  */
 class ThreadPoolManager {
 protected:
-  static BS::thread_pool<> pool;
+  static BS::priority_thread_pool pool;
 
 public:
   // Delete copy and move constructors and assignment operators
@@ -47,15 +55,16 @@ public:
    * @param K K for GEMM or GEMV
    * @return std::size_t number of thread to use
    */
-  std::size_t select_k_quant_thread_count(unsigned int M, unsigned int N,
-                                          unsigned int K);
+  static std::size_t select_k_quant_thread_count(unsigned int M,
+                                                 unsigned int N,
+                                                 unsigned int K);
 
   /**
    * @brief Static method to access the single instance
    *
-   * @return BS::thread_pool<>&
+   * @return BS::priority_thread_pool&
    */
-  static BS::thread_pool<> &getInstance() { return pool; }
+  static BS::priority_thread_pool &getInstance() { return pool; }
 
 private:
   /**
@@ -69,6 +78,106 @@ private:
    */
   ~ThreadPoolManager() = default;
 };
+
+/**
+ * @brief TaskGroup tracks a subset of the tasks submitted to a thread pool with
+ * its own counter, so that wait() returns as soon as this group's tasks are
+ * done instead of waiting for every task in the pool like
+ * BS::thread_pool::wait() does. A group can be bound to a cancel flag: once it
+ * is set, tasks of the group that have not started yet return without running.
+ *
+ */
+class TaskGroup {
+public:
+  /**
+   * @brief Construct a new Task Group object
+   *
+   * @param pool thread pool the group's tasks run on
+   * @param cancelled flag that drops the group's queued tasks when set, may be
+   * nullptr
+   */
+  explicit TaskGroup(
+    BS::priority_thread_pool &pool = ThreadPoolManager::getInstance(),
+    const std::atomic<bool> *cancelled = nullptr) :
+    pool(pool), cancelled(cancelled) {}
+
+  /**
+   * @brief Destroy the Task Group object. Waits for the group's tasks since
+   * they refer to the group.
+   *
+   */
+  ~TaskGroup() { wait(); }
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  /**
+   * @brief Submit a task to the pool as part of this group
+   *
+   * @tparam F The type of the function.
+   * @param task The function to submit.
+   * @param priority The priority of the task, see BS::thread_pool::detach_task
+   */
+  template <typename F>
+  void detach_task(F &&task, const BS::priority_t priority = 0) {
+    {
+      std::scoped_lock lock(group_mutex);
+      ++tasks_pending;
+    }
+    pool.detach_task(
+      [this, task = std::forward<F>(task)]() mutable {
+        const FinishGuard guard{*this};
+        if (!isCancelled())
+          task();
+      },
+      priority);
+  }
+
+  /**
+   * @brief Wait until every task submitted to this group has finished
+   *
+   */
+  void wait();
+
+  /**
+   * @brief Check whether the group's cancel flag is set
+   *
+   * @return true if queued tasks of the group are dropped
+   */
+  bool isCancelled() const {
+    return cancelled && cancelled->load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get the number of tasks of this group that have not finished yet
+   *
+   * @return std::size_t number of unfinished tasks
+   */
+  std::size_t get_tasks_pending() const;
+
+private:
+  /**
+   * @brief Marks a task finished when it goes out of scope, even if the task
+   * threw
+   *
+   */
+  struct FinishGuard {
+    TaskGroup &group;
+    ~FinishGuard() { group.finish_task(); }
+  };
+
+  /**
+   * @brief Decrease the pending counter and wake waiters on the last task
+   *
+   */
+  void finish_task();
+
+  BS::priority_thread_pool &pool;
+  const std::atomic<bool> *cancelled;
+  std::size_t tasks_pending = 0;
+  mutable std::mutex group_mutex;
+  std::condition_variable tasks_done_cv;
+};
 } // namespace nntrainer
 
 #endif // THREAD_POOL_MANAGER_HPP
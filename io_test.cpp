@@ -2,17 +2,24 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <random>
+#include <stream_copy.hpp>
+#include <string>
 #include <thread>
 #include <vector>
 
 constexpr size_t LAYER_SIZE = (((3072 * 3072 * 2) + (3072 * 256 * 2) +
                                (3072 * 8192 * 2) + (8192 * 8192)) *
                               4 / 8);
+constexpr size_t COMPUTE_SET = 1024 * 1024;
+constexpr size_t COPY_CHUNK = 1024 * 1024;
+constexpr int COPY_ROUNDS = 8;
 std::atomic<size_t> total_bytes{0};
 // std::vector<char> tmp(2097152);
 
@@ -47,9 +54,76 @@ void benchmark_mmap(const char* path, size_t threads, size_t chunk) {
             << ", time=" << sec << "ms, speed=" << mbps << " MB/s\n";
 }
 
+// one pass over a cache sized working set, like compute over its activations
+// and weight tiles
+double compute_pass_us(const std::vector<uint64_t>& data) {
+  static volatile uint64_t sink = 0;
+  auto t0 = std::chrono::high_resolution_clock::now();
+  // independent sums, so that the pass is bound by loads and not by adds
+  uint64_t sum[4] = {0, 0, 0, 0};
+  for (size_t i = 0; i + 4 <= data.size(); i += 4)
+    for (size_t j = 0; j < 4; ++j) sum[j] += data[i + j];
+  sink = sink + sum[0] + sum[1] + sum[2] + sum[3];
+  auto t1 = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::micro>(t1 - t0).count();
+}
+
+void benchmark_copy(nntrainer::CopyKernel kernel, char* dst, const char* src,
+                    const std::vector<uint64_t>& data) {
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (int r = 0; r < COPY_ROUNDS; ++r)
+    nntrainer::streamCopy(dst, src, LAYER_SIZE, kernel);
+  auto t1 = std::chrono::high_resolution_clock::now();
+  double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+  double mbps = (double(LAYER_SIZE) * COPY_ROUNDS / (1024 * 1024)) / ms * 1000;
+
+  // compute and the chunk copies of a prefetch take turns on the cores, the
+  // pass after a chunk pays for whatever the copy evicted
+  double warm_us = 0.0;
+  double after_copy_us = 0.0;
+  compute_pass_us(data);
+  for (size_t offset = 0; offset < LAYER_SIZE; offset += COPY_CHUNK) {
+    size_t size = std::min(COPY_CHUNK, LAYER_SIZE - offset);
+    warm_us += compute_pass_us(data);
+    nntrainer::streamCopy(dst + offset, src + offset, size, kernel);
+    after_copy_us += compute_pass_us(data);
+  }
+
+  std::cout << "[copy] kernel=" << nntrainer::copyKernelName(kernel)
+            << ", size=" << LAYER_SIZE << ", time=" << ms / COPY_ROUNDS
+            << "ms, speed=" << mbps
+            << " MB/s, compute pass after a chunk=" << after_copy_us / warm_us
+            << "x of warm\n";
+}
+
+void benchmark_copies() {
+  std::vector<char> src(LAYER_SIZE, 1);
+  char* dst = static_cast<char*>(std::aligned_alloc(4096, LAYER_SIZE));
+  memset(dst, 0, LAYER_SIZE);
+  std::vector<uint64_t> data(COMPUTE_SET / sizeof(uint64_t), 1);
+
+  for (auto kernel :
+       {nntrainer::CopyKernel::MEMCPY, nntrainer::CopyKernel::REP_MOVSB,
+        nntrainer::CopyKernel::AVX2_STREAM,
+        nntrainer::CopyKernel::AVX512_STREAM}) {
+    if (!nntrainer::copyKernelSupported(kernel)) continue;
+    benchmark_copy(kernel, dst, src.data(), data);
+  }
+  std::cout << "[copy] detected kernel="
+            << nntrainer::copyKernelName(nntrainer::detectCopyKernel())
+            << "\n";
+  free(dst);
+}
+
 int main(int argc, char** argv) {
   const char* path = "./weights.bin";
 
+  // staging copies only, no weights file needed
+  if (argc > 1 && std::string(argv[1]) == "--copy") {
+    benchmark_copies();
+    return 0;
+  }
+
   for (size_t c : {4096, 4096 * 2, 2096 * 3, 4096 * 4, 4096 * 16, 4096 * 32,
                    4096 * 64, 4096 * 128, 4096 * 256, 4096 * 512}) {
     for (size_t threads : {1, 2, 4, 8, 16, 32}) {
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   layer_cache.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Layer cache kept across forward passes source file
+ */
+
+#include "layer_cache.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace nntrainer {
+
+LayerCache::LayerCache(std::size_t num_entries, std::size_t entry_size,
+                       std::size_t alignment, EvictionPolicy policy,
+                       NextUseFunc next_use, SlotMemory memory) :
+  storage(num_entries, entry_size, alignment, memory),
+  policy(policy),
+  next_use(std::move(next_use)),
+  entries(num_entries) {
+  if (policy == EvictionPolicy::NEXT_USE && !this->next_use)
+    throw std::invalid_argument("NEXT_USE eviction needs a next use function");
+}
+
+void *LayerCache::pin(int layer_id) {
+  std::scoped_lock lock(cache_mutex);
+  auto it = cached.find(layer_id);
+  if (it == cached.end()) {
+    ++misses;
+    return nullptr;
+  }
+  Entry &entry = entries[it->second];
+  ++entry.pins;
+  entry.last_use = ++clock;
+  ++hits;
+  return storage.buffers()[it->second];
+}
+
+void *LayerCache::admit(int layer_id, std::size_t reuse_distance) {
+  std::scoped_lock lock(cache_mutex);
+  if (cached.count(layer_id))
+    return nullptr;
+
+  const int index = victim(reuse_distance);
+  if (index < 0)
+    return nullptr;
+
+  Entry &entry = entries[index];
+  if (entry.layer_id != NO_LAYER) {
+    cached.erase(entry.layer_id);
+    ++evictions;
+  }
+  entry.layer_id = layer_id;
+  entry.pins = 1;
+  entry.last_use = ++clock;
+  cached[layer_id] = index;
+  return storage.buffers()[index];
+}
+
+void LayerCache::unpin(int layer_id) {
+  std::scoped_lock lock(cache_mutex);
+  auto it = cached.find(layer_id);
+  if (it != cached.end() && entries[it->second].pins > 0)
+    --entries[it->second].pins;
+}
+
+void LayerCache::drop(int layer_id) {
+  std::scoped_lock lock(cache_mutex);
+  auto it = cached.find(layer_id);
+  if (it == cached.end())
+    return;
+  entries[it->second] = Entry();
+  cached.erase(it);
+}
+
+int LayerCache::entryIndex(int layer_id) const {
+  std::scoped_lock lock(cache_mutex);
+  auto it = cached.find(layer_id);
+  return it == cached.end() ? -1 : static_cast<int>(it->second);
+}
+
+int LayerCache::victim(std::size_t reuse_distance) const {
+  int best = -1;
+  std::size_t best_next_use = 0;
+
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    const Entry &entry = entries[i];
+    if (entry.layer_id == NO_LAYER)
+      return static_cast<int>(i);
+    if (entry.pins > 0)
+      continue;
+
+    if (policy == EvictionPolicy::LRU) {
+      if (best < 0 || entry.last_use < entries[best].last_use)
+        best = static_cast<int>(i);
+    } else {
+      const std::size_t use = next_use(entry.layer_id);
+      if (best < 0 || use > best_next_use) {
+        best = static_cast<int>(i);
+        best_next_use = use;
+      }
+    }
+  }
+
+  // keeping the cached layer saves a load sooner than caching the new one
+  if (policy == EvictionPolicy::NEXT_USE && best >= 0 &&
+      best_next_use <= reuse_distance)
+    return -1;
+  return best;
+}
+
+std::size_t LayerCache::getHits() const {
+  std::scoped_lock lock(cache_mutex);
+  return hits;
+}
+
+std::size_t LayerCache::getMisses() const {
+  std::scoped_lock lock(cache_mutex);
+  return misses;
+}
+
+std::size_t LayerCache::getEvictions() const {
+  std::scoped_lock lock(cache_mutex);
+  return evictions;
+}
+} // namespace nntrainer
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   layer_cache.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Layer cache kept across forward passes header file
+ */
+
+#ifndef LAYER_CACHE_HPP
+#define LAYER_CACHE_HPP
+
+#pragma once
+#include "layer_slot_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace nntrainer {
+
+/**
+ * @brief Which cached layer makes room for a new one
+ *
+ */
+enum class EvictionPolicy {
+  LRU,     /**< evict the least recently used layer */
+  NEXT_USE /**< evict the layer needed furthest in the future, and keep the
+              cache as is when the new layer is needed even later */
+};
+
+/**
+ * @brief LayerCache keeps loaded layers in a fixed number of entries so that
+ * the next forward pass can use them without reading the file again. A layer
+ * is pinned while it is being loaded or computed and is never evicted then.
+ *
+ */
+class LayerCache {
+public:
+  /**
+   * @brief Number of steps until a layer is needed next, used by NEXT_USE
+   *
+   */
+  using NextUseFunc = std::function<std::size_t(int)>;
+
+  /**
+   * @brief Construct a new Layer Cache object
+   *
+   * @param num_entries number of layers the cache holds
+   * @param entry_size size of a single entry in bytes
+   * @param alignment alignment of every entry buffer
+   * @param policy eviction policy
+   * @param next_use next use of a cached layer, required for NEXT_USE
+   * @param memory backing memory of the entries
+   * @throws std::invalid_argument if NEXT_USE is requested without next_use
+   */
+  LayerCache(std::size_t num_entries, std::size_t entry_size,
+             std::size_t alignment, EvictionPolicy policy = EvictionPolicy::LRU,
+             NextUseFunc next_use = nullptr,
+             SlotMemory memory = SlotMemory::ALIGNED);
+
+  /**
+   * @brief Look a layer up and pin it on a hit
+   *
+   * @param layer_id layer id
+   * @return void* cached weights, or nullptr on a miss
+   */
+  void *pin(int layer_id);
+
+  /**
+   * @brief Make room for a missed layer so that it can be loaded straight into
+   * the cache. The returned entry is pinned.
+   *
+   * @param layer_id layer id
+   * @param reuse_distance steps until the layer is needed again after the use
+   * it is loaded for, compared against next_use of the victim by NEXT_USE
+   * @return void* entry to load the layer into, or nullptr if not admitted
+   */
+  void *admit(int layer_id, std::size_t reuse_distance);
+
+  /**
+   * @brief Unpin a layer taken with pin() or admit()
+   *
+   * @param layer_id layer id
+   */
+  void unpin(int layer_id);
+
+  /**
+   * @brief Unpin and forget a layer, e.g. when loading it failed
+   *
+   * @param layer_id layer id
+   */
+  void drop(int layer_id);
+
+  /**
+   * @brief Get the entry index a cached layer lives in
+   *
+   * @param layer_id layer id
+   * @return int entry index, or -1 if the layer is not cached
+   */
+  int entryIndex(int layer_id) const;
+
+  /**
+   * @brief Get all entry buffers, in entry index order
+   *
+   * @return const std::vector<void *>& entry buffers
+   */
+  const std::vector<void *> &buffers() const { return storage.buffers(); }
+
+  /**
+   * @brief Get the number of entries
+   *
+   * @return std::size_t number of entries
+   */
+  std::size_t size() const { return entries.size(); }
+
+  /**
+   * @brief Get the size of a single entry
+   *
+   * @return std::size_t entry size in bytes
+   */
+  std::size_t entrySize() const { return storage.slotSize(); }
+
+  /**
+   * @brief Fault in every page of every entry, see LayerSlotPool::prefault()
+   *
+   * @param pool thread pool to run on
+   * @param chunk_size bytes faulted in by a single task
+   */
+  void prefault(BS::priority_thread_pool &pool, std::size_t chunk_size) {
+    storage.prefault(pool, chunk_size);
+  }
+
+  /**
+   * @brief mlock every entry so it can never be swapped out
+   *
+   * @return true if every entry was locked
+   */
+  bool lock() { return storage.lock(); }
+
+  /**
+   * @brief Get the number of pin() calls that hit
+   *
+   * @return std::size_t number of hits
+   */
+  std::size_t getHits() const;
+
+  /**
+   * @brief Get the number of pin() calls that missed
+   *
+   * @return std::size_t number of misses
+   */
+  std::size_t getMisses() const;
+
+  /**
+   * @brief Get the number of layers evicted to admit another one
+   *
+   * @return std::size_t number of evictions
+   */
+  std::size_t getEvictions() const;
+
+private:
+  static constexpr int NO_LAYER = -1;
+
+  /**
+   * @brief A cache entry
+   *
+   */
+  struct Entry {
+    int layer_id = NO_LAYER;
+    unsigned int pins = 0;
+    std::uint64_t last_use = 0;
+  };
+
+  /**
+   * @brief Pick the entry to reuse for a new layer
+   *
+   * @param reuse_distance steps until the new layer is needed again
+   * @return int entry index, or -1 if nothing may be evicted
+   */
+  int victim(std::size_t reuse_distance) const;
+
+  LayerSlotPool storage;
+  EvictionPolicy policy;
+  NextUseFunc next_use;
+  std::vector<Entry> entries;
+  std::unordered_map<int, std::size_t> cached;
+  std::uint64_t clock = 0;
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+  std::size_t evictions = 0;
+  mutable std::mutex cache_mutex;
+};
+} // namespace nntrainer
+
+#endif // LAYER_CACHE_HPP
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   layer_ready_event.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Per-layer readiness event source file
+ */
+
+#include "layer_ready_event.hpp"
+
+namespace nntrainer {
+
+void LayerReadyEvent::arm(std::size_t chunks) {
+  std::scoped_lock lock(ready_mutex);
+  pending = chunks;
+  ready = chunks == 0;
+}
+
+void LayerReadyEvent::reset() {
+  std::scoped_lock lock(ready_mutex);
+  pending = 0;
+  ready = false;
+}
+
+void LayerReadyEvent::chunkDone() {
+  if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    set();
+}
+
+void LayerReadyEvent::set() {
+  {
+    std::scoped_lock lock(ready_mutex);
+    ready = true;
+  }
+  ready_cv.notify_all();
+}
+
+void LayerReadyEvent::wait() {
+  std::unique_lock lock(ready_mutex);
+  ready_cv.wait(lock, [this] { return ready; });
+}
+
+bool LayerReadyEvent::isReady() {
+  std::scoped_lock lock(ready_mutex);
+  return ready;
+}
+} // namespace nntrainer
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   layer_ready_event.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Per-layer readiness event header file
+ */
+
+#ifndef LAYER_READY_EVENT_HPP
+#define LAYER_READY_EVENT_HPP
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace nntrainer {
+/**
+ * @brief LayerReadyEvent signals that every chunk of a layer has landed in its
+ * buffer. The loader arms it with the number of chunks it is about to issue,
+ * each chunk reports completion, and the last one wakes the waiting compute
+ * thread.
+ *
+ */
+class LayerReadyEvent {
+public:
+  /**
+   * @brief Reset the event to not-ready and expect the given number of chunks
+   *
+   * @param chunks number of chunkDone() calls that make the layer ready
+   */
+  void arm(std::size_t chunks);
+
+  /**
+   * @brief Reset the event to not-ready before the layer is loaded again, so
+   * that a wait() does not see the previous load
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Report that one chunk has landed. The last chunk sets the event.
+   *
+   */
+  void chunkDone();
+
+  /**
+   * @brief Mark the layer ready regardless of outstanding chunks (e.g. when
+   * the load failed and nothing more will arrive)
+   *
+   */
+  void set();
+
+  /**
+   * @brief Block until the layer is ready
+   *
+   */
+  void wait();
+
+  /**
+   * @brief Check whether the layer is ready without blocking
+   *
+   * @return true if the layer is ready
+   */
+  bool isReady();
+
+private:
+  std::atomic<std::size_t> pending{0};
+  bool ready = false;
+  std::mutex ready_mutex;
+  std::condition_variable ready_cv;
+};
+} // namespace nntrainer
+
+#endif // LAYER_READY_EVENT_HPP
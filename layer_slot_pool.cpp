@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   layer_slot_pool.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Bounded ring buffer of layer slots source file
+ */
+
+#include "layer_slot_pool.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+namespace nntrainer {
+
+namespace {
+constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+constexpr std::size_t PAGE_SIZE = 4096;
+
+std::size_t align_up(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+LayerSlotPool::LayerSlotPool(std::size_t num_slots, std::size_t slot_size,
+                             std::size_t alignment, SlotMemory memory) :
+  slot_size(slot_size),
+  owners(num_slots, FREE_SLOT),
+  turns(num_slots),
+  trimmed(num_slots, false),
+  active(num_slots) {
+  if (num_slots == 0)
+    throw std::invalid_argument("slot pool needs at least one slot");
+
+  allocations.reserve(num_slots);
+  slots.reserve(num_slots);
+  for (std::size_t i = 0; i < num_slots; ++i) {
+    Allocation allocation = allocate(memory, alignment);
+    if (!allocation.base) {
+      freeSlots();
+      throw std::bad_alloc();
+    }
+    allocations.push_back(allocation);
+    slots.push_back(allocation.base);
+  }
+}
+
+LayerSlotPool::~LayerSlotPool() { freeSlots(); }
+
+LayerSlotPool::Allocation LayerSlotPool::allocate(SlotMemory memory,
+                                                  std::size_t alignment) const {
+  if (memory == SlotMemory::HUGETLB) {
+    std::size_t length = align_up(slot_size, HUGE_PAGE_SIZE);
+    void *ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED)
+      return {ptr, length, SlotMemory::HUGETLB};
+    memory = SlotMemory::THP;
+  }
+
+  if (memory == SlotMemory::THP) {
+    // over-map by one huge page so the slot can start on a 2 MiB boundary
+    std::size_t length = align_up(slot_size, HUGE_PAGE_SIZE);
+    void *ptr = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr != MAP_FAILED) {
+      char *raw = static_cast<char *>(ptr);
+      char *base = reinterpret_cast<char *>(
+        align_up(reinterpret_cast<std::uintptr_t>(raw), HUGE_PAGE_SIZE));
+      if (base > raw)
+        munmap(raw, base - raw);
+      munmap(base + length, raw + HUGE_PAGE_SIZE - base);
+      if (madvise(base, length, MADV_HUGEPAGE) == 0)
+        return {base, length, SlotMemory::THP};
+      munmap(base, length);
+    }
+  }
+
+  void *ptr = nullptr;
+  if (posix_memalign(&ptr, alignment, slot_size) != 0)
+    return {nullptr, 0, SlotMemory::ALIGNED};
+  return {ptr, slot_size, SlotMemory::ALIGNED};
+}
+
+void LayerSlotPool::freeSlots() {
+  for (const auto &allocation : allocations) {
+    if (locked)
+      munlock(allocation.base, allocation.length);
+    if (allocation.memory == SlotMemory::ALIGNED)
+      free(allocation.base);
+    else
+      munmap(allocation.base, allocation.length);
+  }
+  allocations.clear();
+  slots.clear();
+}
+
+std::size_t LayerSlotPool::countSlots(SlotMemory memory) const {
+  return std::count_if(
+    allocations.begin(), allocations.end(),
+    [memory](const Allocation &a) { return a.memory == memory; });
+}
+
+void LayerSlotPool::prefault(BS::priority_thread_pool &pool,
+                             std::size_t chunk_size) {
+  chunk_size = align_up(std::max(chunk_size, PAGE_SIZE), PAGE_SIZE);
+
+  TaskGroup group(pool);
+  for (std::size_t s = 0; s < getActive(); ++s) {
+    const Allocation &allocation = allocations[s];
+    char *base = static_cast<char *>(allocation.base);
+    for (std::size_t offset = 0; offset < allocation.length;
+         offset += chunk_size) {
+      std::size_t size = std::min(chunk_size, allocation.length - offset);
+      group.detach_task([base, offset, size] {
+        if (madvise(base + offset, size, MADV_POPULATE_WRITE) == 0)
+          return;
+        // kernels before 5.14 lack MADV_POPULATE_WRITE, write every page
+        for (std::size_t i = 0; i < size; i += PAGE_SIZE)
+          static_cast<volatile char *>(base + offset)[i] = 0;
+      });
+    }
+  }
+  group.wait();
+}
+
+bool LayerSlotPool::lock() {
+  bool all_locked = true;
+  for (const auto &allocation : allocations)
+    all_locked &= mlock(allocation.base, allocation.length) == 0;
+  locked = true;
+  keepResident();
+  return all_locked;
+}
+
+void LayerSlotPool::keepResident() {
+  std::scoped_lock lock(owners_mutex);
+  keep_resident = true;
+}
+
+std::size_t LayerSlotPool::residentBytes() const {
+  std::size_t resident = 0;
+  std::vector<unsigned char> pages;
+  for (const auto &allocation : allocations) {
+    pages.resize((allocation.length + PAGE_SIZE - 1) / PAGE_SIZE);
+    if (mincore(allocation.base, allocation.length, pages.data()) != 0)
+      continue;
+    for (unsigned char page : pages)
+      resident += (page & 1) * PAGE_SIZE;
+  }
+  return resident;
+}
+
+void LayerSlotPool::setActive(std::size_t count) {
+  std::scoped_lock lock(owners_mutex);
+  active = std::clamp<std::size_t>(count, 1, slots.size());
+  if (next_slot >= active)
+    next_slot = 0;
+  for (std::size_t index = active; index < slots.size(); ++index)
+    advance(FREE_SLOT, static_cast<int>(index));
+}
+
+std::size_t LayerSlotPool::getActive() const {
+  std::scoped_lock lock(owners_mutex);
+  return active;
+}
+
+int LayerSlotPool::mapLayer(int layer_id) {
+  for (; next_layer <= layer_id; ++next_layer) {
+    turns[next_slot].push_back(next_layer);
+    mapped[next_layer] = static_cast<int>(next_slot);
+    next_slot = (next_slot + 1) % active;
+  }
+  auto it = mapped.find(layer_id);
+  if (it == mapped.end())
+    throw std::invalid_argument("layer " + std::to_string(layer_id) +
+                                " already left its slot");
+  return it->second;
+}
+
+void LayerSlotPool::advance(int layer_id, int index) {
+  if (layer_id != FREE_SLOT) {
+    turns[index].pop_front();
+    mapped.erase(layer_id);
+  }
+  if (static_cast<std::size_t>(index) < active || keep_resident ||
+      owners[index] != FREE_SLOT || !turns[index].empty() || trimmed[index])
+    return;
+
+  // nobody will read the slot before a load writes it again, which faults
+  // fresh pages in
+  const Allocation &allocation = allocations[index];
+  madvise(allocation.base, allocation.length / PAGE_SIZE * PAGE_SIZE,
+          MADV_DONTNEED);
+  trimmed[index] = true;
+}
+
+int LayerSlotPool::slotIndex(int layer_id) {
+  std::scoped_lock lock(owners_mutex);
+  return mapLayer(layer_id);
+}
+
+void *LayerSlotPool::acquire(int layer_id) {
+  std::unique_lock lock(owners_mutex);
+  const int index = mapLayer(layer_id);
+  slot_released_cv.wait(lock, [&] {
+    return owners[index] == FREE_SLOT && turns[index].front() == layer_id;
+  });
+  owners[index] = layer_id;
+  trimmed[index] = false;
+  return slots[index];
+}
+
+void *LayerSlotPool::tryAcquire(int layer_id) {
+  std::scoped_lock lock(owners_mutex);
+  const int index = mapLayer(layer_id);
+  if (owners[index] != FREE_SLOT || turns[index].front() != layer_id)
+    return nullptr;
+  owners[index] = layer_id;
+  trimmed[index] = false;
+  return slots[index];
+}
+
+void LayerSlotPool::release(int layer_id) {
+  {
+    std::scoped_lock lock(owners_mutex);
+    auto it = mapped.find(layer_id);
+    if (it == mapped.end() || owners[it->second] != layer_id)
+      return;
+    const int index = it->second;
+    owners[index] = FREE_SLOT;
+    advance(layer_id, index);
+  }
+  slot_released_cv.notify_all();
+}
+
+void LayerSlotPool::skip(int layer_id) {
+  {
+    std::unique_lock lock(owners_mutex);
+    const int index = mapLayer(layer_id);
+    slot_released_cv.wait(lock, [&] {
+      return owners[index] == FREE_SLOT && turns[index].front() == layer_id;
+    });
+    advance(layer_id, index);
+  }
+  slot_released_cv.notify_all();
+}
+} // namespace nntrainer
@@ -0,0 +1,271 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   layer_slot_pool.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Bounded ring buffer of layer slots header file
+ */
+
+#ifndef LAYER_SLOT_POOL_HPP
+#define LAYER_SLOT_POOL_HPP
+
+#pragma once
+#include "bs_thread_pool_manager.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace nntrainer {
+
+/**
+ * @brief Backing memory of the slots
+ *
+ */
+enum class SlotMemory {
+  ALIGNED, /**< posix_memalign, 4 KiB pages */
+  THP,     /**< anonymous mapping with madvise(MADV_HUGEPAGE) */
+  HUGETLB  /**< MAP_HUGETLB from the reserved huge page pool */
+};
+
+/**
+ * @brief LayerSlotPool owns a fixed number of equally sized layer buffers used
+ * as a ring. Layers are mapped onto the first active slots in turn, in the
+ * order of their ids, starting with id 0: with all slots active, layer i
+ * lands in slot (i % num_slots). A slot is owned by one layer from acquire()
+ * until release(), and is handed out in the order layers were mapped onto it,
+ * so a layer mapped onto a slot that is still in use, or still awaited by an
+ * earlier layer, waits (or is rejected by tryAcquire()). When the same layer
+ * is loaded more than once (e.g. once per token), the ids passed in are
+ * positions in the load order rather than model layer indices.
+ *
+ * Fewer active slots keep less memory resident: a slot outside the active
+ * ones gives its pages back to the kernel once no layer is left on it, and
+ * faults them in again when a layer is loaded into it.
+ *
+ */
+class LayerSlotPool {
+public:
+  /**
+   * @brief Construct a new Layer Slot Pool object
+   *
+   * @param num_slots number of slots in the ring
+   * @param slot_size size of a single slot in bytes
+   * @param alignment alignment of every slot buffer
+   * @param memory requested backing memory. HUGETLB falls back to THP when
+   * the huge page pool is exhausted, THP falls back to 4 KiB pages when the
+   * kernel refuses the hint.
+   * @throws std::bad_alloc if a slot can not be allocated
+   */
+  LayerSlotPool(std::size_t num_slots, std::size_t slot_size,
+                std::size_t alignment,
+                SlotMemory memory = SlotMemory::ALIGNED);
+
+  /**
+   * @brief Destroy the Layer Slot Pool object
+   *
+   */
+  ~LayerSlotPool();
+
+  LayerSlotPool(const LayerSlotPool &) = delete;
+  LayerSlotPool &operator=(const LayerSlotPool &) = delete;
+
+  /**
+   * @brief Take the slot of the given layer, waiting until the previous layer
+   * mapped onto it has released it
+   *
+   * @param layer_id layer to load into the slot
+   * @return void* slot buffer
+   */
+  void *acquire(int layer_id);
+
+  /**
+   * @brief Take the slot of the given layer if it is free
+   *
+   * @param layer_id layer to load into the slot
+   * @return void* slot buffer, or nullptr if it is not this layer's turn yet
+   */
+  void *tryAcquire(int layer_id);
+
+  /**
+   * @brief Give the slot back once the layer is no longer needed. Does nothing
+   * if the layer does not own its slot.
+   *
+   * @param layer_id layer that owns the slot
+   */
+  void release(int layer_id);
+
+  /**
+   * @brief Pass the slot turn of a layer that does not need a slot (e.g. it is
+   * served from a cache) on to the next layer mapped onto the slot. Waits
+   * until the previous layer mapped onto the slot has released it.
+   *
+   * @param layer_id layer whose turn is skipped
+   */
+  void skip(int layer_id);
+
+  /**
+   * @brief Get the buffer a layer is (or will be) loaded into
+   *
+   * @param layer_id layer id, not released or skipped yet
+   * @return void* slot buffer
+   */
+  void *operator[](int layer_id) { return slots[slotIndex(layer_id)]; }
+
+  /**
+   * @brief Get the slot index a layer maps to. Maps the layer, and every
+   * layer before it, onto a slot if that has not happened yet.
+   *
+   * @param layer_id layer id, not released or skipped yet
+   * @return int slot index
+   */
+  int slotIndex(int layer_id);
+
+  /**
+   * @brief Set the number of slots layers are mapped onto from now on. Layers
+   * already mapped keep their slot. Slots outside the active ones give their
+   * pages back once no layer is left on them.
+   *
+   * @param count number of active slots, clamped to [1, size()]
+   */
+  void setActive(std::size_t count);
+
+  /**
+   * @brief Get the number of slots layers are mapped onto
+   *
+   * @return std::size_t number of active slots
+   */
+  std::size_t getActive() const;
+
+  /**
+   * @brief Never give slot pages back, e.g. once io_uring has pinned them as
+   * registered buffers
+   *
+   */
+  void keepResident();
+
+  /**
+   * @brief Get the slot bytes resident in memory right now
+   *
+   * @return std::size_t resident bytes
+   */
+  std::size_t residentBytes() const;
+
+  /**
+   * @brief Get all slot buffers, in slot index order
+   *
+   * @return const std::vector<void *>& slot buffers
+   */
+  const std::vector<void *> &buffers() const { return slots; }
+
+  /**
+   * @brief Get the number of slots
+   *
+   * @return std::size_t number of slots
+   */
+  std::size_t size() const { return slots.size(); }
+
+  /**
+   * @brief Get the size of a single slot
+   *
+   * @return std::size_t slot size in bytes
+   */
+  std::size_t slotSize() const { return slot_size; }
+
+  /**
+   * @brief Get the number of slots that ended up with the given backing memory
+   *
+   * @param memory backing memory
+   * @return std::size_t number of slots
+   */
+  std::size_t countSlots(SlotMemory memory) const;
+
+  /**
+   * @brief Fault in every page of every active slot, splitting the work into
+   * chunk_size pieces on the given thread pool
+   *
+   * @param pool thread pool to run on
+   * @param chunk_size bytes faulted in by a single task
+   */
+  void prefault(BS::priority_thread_pool &pool, std::size_t chunk_size);
+
+  /**
+   * @brief mlock every slot so it can never be swapped out. Slots then keep
+   * their pages, see keepResident().
+   *
+   * @return true if every slot was locked
+   */
+  bool lock();
+
+private:
+  /**
+   * @brief How a slot was allocated, needed to free it
+   *
+   */
+  struct Allocation {
+    void *base;
+    std::size_t length;
+    SlotMemory memory;
+  };
+
+  /**
+   * @brief Allocate one slot, falling back to smaller pages if needed
+   *
+   * @param memory requested backing memory
+   * @param alignment alignment of the slot buffer
+   * @return Allocation the allocation, base is nullptr on failure
+   */
+  Allocation allocate(SlotMemory memory, std::size_t alignment) const;
+
+  /**
+   * @brief Free every allocated slot
+   *
+   */
+  void freeSlots();
+
+  /**
+   * @brief Map every layer up to the given one onto a slot, lock held
+   *
+   * @param layer_id last layer to map
+   * @return int slot index of the layer
+   */
+  int mapLayer(int layer_id);
+
+  /**
+   * @brief Drop the next layer of a slot and give the slot pages back if it
+   * is left idle outside the active slots, lock held
+   *
+   * @param layer_id layer leaving the slot
+   * @param index slot index
+   */
+  void advance(int layer_id, int index);
+
+  static constexpr int FREE_SLOT = -1;
+
+  std::size_t slot_size;
+  bool locked = false;
+  bool keep_resident = false;
+  std::vector<Allocation> allocations;
+  std::vector<void *> slots;
+  std::vector<int> owners;
+  std::vector<std::deque<int>> turns; /**< layers mapped onto each slot, in
+                                         the order they get it */
+  std::vector<bool> trimmed;          /**< pages given back to the kernel */
+  std::unordered_map<int, int> mapped; /**< slot of every mapped layer until
+                                          it leaves the slot */
+  std::size_t active;
+  std::size_t next_slot = 0;
+  int next_layer = 0;
+  mutable std::mutex owners_mutex;
+  std::condition_variable slot_released_cv;
+};
+} // namespace nntrainer
+
+#endif // LAYER_SLOT_POOL_HPP
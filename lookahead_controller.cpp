@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   lookahead_controller.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Adaptive prefetch depth controller source file
+ */
+
+#include "lookahead_controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nntrainer {
+
+namespace {
+double ema(double average, double sample, double alpha) {
+  return average == 0.0 ? sample : alpha * sample + (1.0 - alpha) * average;
+}
+} // namespace
+
+LookaheadController::LookaheadController(std::size_t initial_depth,
+                                         std::size_t min_depth,
+                                         std::size_t max_depth,
+                                         std::size_t window) :
+  depth(std::clamp(initial_depth, min_depth, max_depth)),
+  min_depth(min_depth),
+  max_depth(max_depth),
+  window(window) {
+  if (min_depth == 0 || min_depth > max_depth)
+    throw std::invalid_argument("invalid look-ahead bounds");
+}
+
+void LookaheadController::recordLoad(double load_ms) {
+  auto now = std::chrono::steady_clock::now();
+  std::scoped_lock lock(stats_mutex);
+  load_ema = ema(load_ema, load_ms, EMA_ALPHA);
+  if (has_last_load)
+    interval_ema = ema(
+      interval_ema,
+      std::chrono::duration<double, std::milli>(now - last_load).count(),
+      EMA_ALPHA);
+  last_load = now;
+  has_last_load = true;
+}
+
+void LookaheadController::recordCompute(double compute_ms, double stall_ms) {
+  std::scoped_lock lock(stats_mutex);
+  compute_ema = ema(compute_ema, compute_ms, EMA_ALPHA);
+  if (stall_ms > STALL_THRESHOLD_MS) {
+    ++stalls;
+    quiet_layers = 0;
+  } else {
+    ++quiet_layers;
+  }
+}
+
+std::size_t LookaheadController::update() {
+  std::scoped_lock lock(stats_mutex);
+  if (load_ema == 0.0 || compute_ema == 0.0)
+    return depth;
+
+  // layers are consumed at the pace of the slower of compute and I/O
+  const double consume_ms = std::max(compute_ema, interval_ema);
+  std::size_t target =
+    static_cast<std::size_t>(std::ceil(load_ema / consume_ms)) + 1;
+
+  // stalls while compute-bound mean the window is too shallow; while
+  // I/O-bound a deeper window would only hold more memory
+  if (stalls > 0 && interval_ema <= compute_ema)
+    target = std::max(target, depth + 1);
+  stalls = 0;
+
+  target = std::clamp(target, min_depth, max_depth);
+  if (target > depth) {
+    depth = target;
+    quiet_layers = 0;
+  } else if (target < depth && quiet_layers >= window) {
+    --depth;
+    quiet_layers = 0;
+  }
+  return depth;
+}
+
+std::size_t LookaheadController::getDepth() const {
+  std::scoped_lock lock(stats_mutex);
+  return depth;
+}
+} // namespace nntrainer
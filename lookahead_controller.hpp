@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   lookahead_controller.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Adaptive prefetch depth controller header file
+ */
+
+#ifndef LOOKAHEAD_CONTROLLER_HPP
+#define LOOKAHEAD_CONTROLLER_HPP
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace nntrainer {
+/**
+ * @brief LookaheadController picks how many layers to keep in flight from the
+ * measured load latency, the interval between load completions and the
+ * compute time per layer. By Little's law the depth needed to hide a load of
+ * latency L is L divided by the time between two layers being consumed, which
+ * is the slower of compute and I/O throughput. Depth grows immediately and
+ * shrinks one step at a time after a quiet window, within [min, max].
+ *
+ */
+class LookaheadController {
+public:
+  /**
+   * @brief Construct a new Lookahead Controller object
+   *
+   * @param initial_depth depth to start with
+   * @param min_depth lower bound of the depth
+   * @param max_depth upper bound of the depth, e.g. derived from a memory cap
+   * @param window number of computed layers without stalls before shrinking
+   */
+  LookaheadController(std::size_t initial_depth, std::size_t min_depth,
+                      std::size_t max_depth, std::size_t window = 8);
+
+  /**
+   * @brief Record a finished load. Thread safe.
+   *
+   * @param load_ms load latency in milliseconds
+   */
+  void recordLoad(double load_ms);
+
+  /**
+   * @brief Record a computed layer
+   *
+   * @param compute_ms compute time in milliseconds
+   * @param stall_ms time compute waited for the layer in milliseconds
+   */
+  void recordCompute(double compute_ms, double stall_ms);
+
+  /**
+   * @brief Re-evaluate the depth from the recent measurements
+   *
+   * @return std::size_t new depth
+   */
+  std::size_t update();
+
+  /**
+   * @brief Get the current depth
+   *
+   * @return std::size_t current depth
+   */
+  std::size_t getDepth() const;
+
+  /**
+   * @brief Get the upper bound of the depth
+   *
+   * @return std::size_t maximum depth
+   */
+  std::size_t getMaxDepth() const { return max_depth; }
+
+private:
+  static constexpr double EMA_ALPHA = 0.25;
+  static constexpr double STALL_THRESHOLD_MS = 0.05;
+
+  std::size_t depth;
+  std::size_t min_depth;
+  std::size_t max_depth;
+  std::size_t window;
+
+  double load_ema = 0.0;
+  double interval_ema = 0.0;
+  double compute_ema = 0.0;
+  std::size_t stalls = 0;
+  std::size_t quiet_layers = 0;
+  bool has_last_load = false;
+  std::chrono::steady_clock::time_point last_load;
+  mutable std::mutex stats_mutex;
+};
+} // namespace nntrainer
+
+#endif // LOOKAHEAD_CONTROLLER_HPP
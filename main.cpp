@@ -5,107 +5,1598 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <block_codec.hpp>
 #include <bs_thread_pool_manager.hpp>
 #include <chrono>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <functional>
 #include <future>
 #include <iostream>
+#include <layer_cache.hpp>
+#include <layer_ready_event.hpp>
+#include <layer_slot_pool.hpp>
+#include <lookahead_controller.hpp>
+#include <memory>
+#include <memory_budget.hpp>
+#include <prefetch_engine.hpp>
+#include <q4_dequant.hpp>
+#include <q4_gemv.hpp>
 #include <random>
+#include <request_batcher.hpp>
+#include <residency_planner.hpp>
+#include <staged_pipeline.hpp>
+#include <stream_copy.hpp>
 #include <string>
+#include <system_error>
 #include <thread>
 #include <unordered_map>
+#include <uring_loader.hpp>
 #include <vector>
+#include <weights_container.hpp>
+
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ 22
+#endif
 
 constexpr int NUM_LAYERS = 34;
 constexpr int LOOK_AHEAD = 8;
-constexpr double COMPUTE_TIME = 0.0023;
+constexpr int MAX_LOOK_AHEAD = 16;
+constexpr int SPARE_SLOTS = 1;
+constexpr size_t IO_THREADS = 4;
+constexpr size_t DECODE_QUEUE = 2;
 constexpr size_t LAYER_SIZE = (((3072 * 3072 * 2) + (3072 * 256 * 2) +
                                 (3072 * 8192 * 2) + (8192 * 8192)) *
                                4 / 8);
 constexpr size_t NUM_THREAD = 64;
-const std::string WEIGHTS_FILE = "./weights.bin";
-std::vector<std::future<void>> load_futures;
+constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+constexpr int PRIORITY_STEP = 16;
+constexpr size_t DIRECT_IO_ALIGN = 4096;
+constexpr double CGROUP_BUDGET_RATIO = 0.9;
+constexpr int EXPERTS_PER_TOKEN = 2;
+constexpr float Q4_SCALE = 1.0f / 64;
+constexpr unsigned int ROUTER_SEED = 42;
+std::string weights_file = "./weights.bin";
 auto &bs_thread_pool = nntrainer::ThreadPoolManager::getInstance();
 
-std::vector<void *> memory_pool;
-std::vector<size_t> layer_offsets;
+enum class LoaderMode { MMAP, DIRECT, URING, ZERO_COPY };
+// MAP faults a whole range in inside mmap, CHUNK leaves every chunk to the
+// pool worker that copies it
+enum class PopulateMode { MAP, CHUNK };
+LoaderMode loader_mode = LoaderMode::MMAP;
+PopulateMode populate_mode = PopulateMode::MAP;
+unsigned int uring_queue_depth = 32;
+std::unique_ptr<nntrainer::UringLoader> uring_loader;
+const char *mapped_weights = nullptr;
+
+// layer steps go through read, then decode when it has threads of its own,
+// and are consumed by compute on the main thread
+size_t io_threads = IO_THREADS;
+size_t decode_threads = 0;
+size_t decode_queue = DECODE_QUEUE;
+std::unique_ptr<nntrainer::StagedPipeline> load_pipeline;
+
+int look_ahead = LOOK_AHEAD;
+bool adaptive_look_ahead = false;
+std::unique_ptr<nntrainer::LookaheadController> look_ahead_controller;
+
+size_t mem_budget_mb = 0;
+bool cgroup_budget = false;
+std::unique_ptr<nntrainer::MemoryBudget> memory_budget;
+
+int num_tokens = 1;
+int num_requests = 1;
+double arrival_ms = 0.0;
+size_t max_batch = 1;
+double batch_timeout_ms = 0.0;
+bool continuous_decode = false;
+int early_exit_layer = -1;
+std::atomic<int> compute_step{0};
+
+size_t cache_mem_mb = 0;
+nntrainer::EvictionPolicy cache_policy = nntrainer::EvictionPolicy::NEXT_USE;
+std::unique_ptr<nntrainer::LayerCache> layer_cache;
+
+double slo_ms = 0.0;
+std::vector<std::atomic<bool>> resident_layers;
+
+// mixture-of-experts layers stream their shared tensors with the layer and
+// load only the experts the router picks, keyed layer * num_experts + expert
+bool stream_experts = true;
+bool expert_streaming = false;
+int num_experts = 0;
+int experts_per_token = EXPERTS_PER_TOKEN;
+size_t expert_cache_mb = 0;
+std::unique_ptr<nntrainer::LayerCache> expert_cache;
+std::unique_ptr<nntrainer::PrefetchEngine> expert_prefetcher;
+std::vector<nntrainer::LayerReadyEvent> expert_events;
+std::vector<const char *> expert_buffers;
+std::mt19937 router_rng(ROUTER_SEED);
+std::atomic<size_t> expert_bytes_loaded{0};
+std::atomic<size_t> expert_loads{0};
+
+// compute runs Y = X W^T for every int4 matrix with the weights as loaded,
+// X has one row per token of the pass: the prompt of every request of the
+// batch in its first pass (prefill), one token per request after (decode)
+bool auto_gemv_isa = true;
+nntrainer::GemvIsa gemv_isa = nntrainer::GemvIsa::SCALAR;
+int prompt_tokens = 1;
+size_t max_cols = 0;
+std::vector<float> activations;
+std::vector<float> outputs;
+std::vector<nntrainer::Q8Vector> quantized;
+
+// Q4 tensors of streamed layers are unpacked by the loader workers as their
+// chunks land, Q4 keeps them packed
+nntrainer::DType decode_dtype = nntrainer::DType::Q4;
+std::vector<nntrainer::DequantLayout> dequant_layouts;
+std::atomic<uint64_t> decode_ns{0};
+using ChunkFunc = std::function<void(size_t, const char *, size_t)>;
+
+// the mmap loader copies chunks into slots with this kernel, chosen at
+// startup unless set on the command line
+bool auto_copy_kernel = true;
+nntrainer::CopyKernel copy_kernel = nntrainer::CopyKernel::MEMCPY;
+
+// blocks of a compressed container are inflated by the loader workers
+std::atomic<uint64_t> inflate_ns{0};
+std::atomic<size_t> inflated_bytes{0};
+
+int spare_slots = SPARE_SLOTS;
+nntrainer::SlotMemory slot_memory = nntrainer::SlotMemory::ALIGNED;
+bool prefault_slots = false;
+bool lock_slots = false;
+std::unique_ptr<nntrainer::LayerSlotPool> memory_pool;
+nntrainer::WeightsIndex weights_index;
+int num_layers = NUM_LAYERS;
+std::vector<nntrainer::LayerReadyEvent> layer_events;
+
+struct LayerBuffer {
+  char *data = nullptr;
+  bool cached = false;
+  bool packed = false; /**< read, waiting for the decode stage */
+};
+std::vector<LayerBuffer> layer_buffers;
 int fd = -1;
+int direct_fd = -1;
 
 double total_load_time = 0.0;
 double total_compute_time = 0.0;
+double total_stall_time = 0.0;
+std::vector<double> layer_load_ms;
+std::vector<std::chrono::high_resolution_clock::time_point> layer_load_start;
+std::vector<std::chrono::high_resolution_clock::time_point> layer_load_end;
+std::atomic<size_t> total_bytes_loaded{0};
+std::atomic<size_t> cancelled_loads{0};
+std::atomic<size_t> wasted_bytes{0};
+
+size_t layer_chunk_size(size_t layer_size) {
+  // bounded so that chunks of a more urgent layer never queue for long behind
+  // a chunk that is already running
+  size_t chunk_size = (layer_size + NUM_THREAD - 1) / NUM_THREAD;
+  chunk_size = std::min(chunk_size, MAX_CHUNK_SIZE);
+  return (chunk_size + DIRECT_IO_ALIGN - 1) / DIRECT_IO_ALIGN * DIRECT_IO_ALIGN;
+}
+
+BS::priority_t chunk_priority(int step) {
+  // the layer compute needs next gets the highest priority
+  int distance = std::max(0, step - compute_step.load());
+  return static_cast<BS::priority_t>(
+      std::max<int>(BS::pr::highest - distance * PRIORITY_STEP, BS::pr::lowest));
+}
+
+bool load_weights_index() {
+  try {
+    if (nntrainer::WeightsIndex::isContainer(fd))
+      weights_index = nntrainer::WeightsIndex::read(fd);
+    else
+      weights_index = nntrainer::WeightsIndex::uniform(
+          NUM_LAYERS, nntrainer::WeightsIndex::decoderLayer(3072, 256, 8192));
+  } catch (const std::exception &e) {
+    std::cerr << weights_file << " : " << e.what() << std::endl;
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < weights_index.fileSize()) {
+    std::cerr << weights_file << " is smaller than the "
+              << weights_index.fileSize() << " bytes its layout needs"
+              << std::endl;
+    return false;
+  }
+
+  num_layers = static_cast<int>(weights_index.numLayers());
+  layer_events = std::vector<nntrainer::LayerReadyEvent>(num_layers);
+  layer_buffers = std::vector<LayerBuffer>(num_layers);
+  layer_load_ms = std::vector<double>(num_layers, 0.0);
+  layer_load_start.resize(num_layers);
+  layer_load_end.resize(num_layers);
+  resident_layers = std::vector<std::atomic<bool>>(num_layers);
+  printf("Weights : %s, %d layers, largest layer %zu bytes\n",
+         weights_index.fromContainer() ? "container" : "raw", num_layers,
+         weights_index.maxLayerSize());
+
+  num_experts = static_cast<int>(weights_index.maxExperts());
+  if (num_experts == 0) return true;
+  experts_per_token = std::clamp(experts_per_token, 1, num_experts);
+  // experts are read on their own, O_DIRECT and mmap need them page aligned
+  bool aligned = weights_index.tensorAlignment() % DIRECT_IO_ALIGN == 0;
+  expert_streaming = stream_experts && aligned;
+  if (stream_experts && !aligned)
+    std::cerr << "Tensor alignment " << weights_index.tensorAlignment()
+              << " is not page aligned, experts are loaded with their layer"
+              << std::endl;
+  expert_events =
+      std::vector<nntrainer::LayerReadyEvent>(num_layers * num_experts);
+  expert_buffers = std::vector<const char *>(num_layers * num_experts);
+  printf("Experts : %d per layer, %d per token, largest %zu bytes, %s\n",
+         num_experts, experts_per_token, weights_index.maxExpertSize(),
+         expert_streaming ? "streamed on demand" : "loaded with their layer");
+  return true;
+}
+
+// bytes of a layer loaded ahead of compute, experts are loaded on demand
+size_t layer_stream_size(int layer_id) {
+  const nntrainer::LayerInfo &layer = weights_index.layer(layer_id);
+  return expert_streaming ? layer.dense_size : layer.size;
+}
+
+size_t max_stream_size() {
+  return expert_streaming ? weights_index.maxDenseSize()
+                          : weights_index.maxLayerSize();
+}
+
+size_t page_align(size_t size) {
+  return (size + DIRECT_IO_ALIGN - 1) / DIRECT_IO_ALIGN * DIRECT_IO_ALIGN;
+}
+
+bool decoding() { return decode_dtype != nntrainer::DType::Q4; }
+
+// decode in its own pipeline stage instead of on the read workers
+bool staged_decode() { return decoding() && decode_threads > 0; }
+
+// unpacked weights fill a slot from its start, the packed layer is read in
+// behind them unless read workers unpack straight from an mmap
+bool unpack_from_mapping() {
+  return loader_mode == LoaderMode::MMAP && !staged_decode() &&
+         !weights_index.compressed();
+}
+
+size_t staging_offset(int layer_id) {
+  if (!decoding() || unpack_from_mapping()) return 0;
+  return page_align(dequant_layouts[layer_id].size());
+}
+
+size_t layer_slot_size(int layer_id) {
+  if (!decoding()) return layer_stream_size(layer_id);
+  if (unpack_from_mapping())
+    return dequant_layouts[layer_id].size();
+  return staging_offset(layer_id) + layer_stream_size(layer_id);
+}
+
+size_t max_slot_size() {
+  size_t size = 0;
+  for (int i = 0; i < num_layers; ++i)
+    size = std::max(size, layer_slot_size(i));
+  return size;
+}
+
+size_t layer_footprint(int layer_id) {
+  if (loader_mode == LoaderMode::ZERO_COPY)
+    return page_align(layer_stream_size(layer_id));
+  return page_align(max_slot_size());
+}
+
+// upper bound, batched requests share passes and end the run earlier
+int total_steps() { return num_requests * num_tokens * num_layers; }
+
+size_t cache_entries() {
+  if (loader_mode == LoaderMode::ZERO_COPY) return 0;
+  size_t entries = cache_mem_mb * 1024 * 1024 / page_align(max_slot_size());
+  return std::min<size_t>(entries, num_layers);
+}
+
+size_t expert_cache_entries() {
+  if (!expert_streaming || loader_mode == LoaderMode::ZERO_COPY) return 0;
+  // the experts of the layer being computed are pinned all at once
+  size_t entries = expert_cache_mb * 1024 * 1024 /
+                   page_align(weights_index.maxExpertSize());
+  return std::clamp<size_t>(entries, experts_per_token,
+                            num_layers * num_experts);
+}
+
+bool init_dequant() {
+  if (!decoding()) return true;
+  if (loader_mode == LoaderMode::ZERO_COPY) {
+    std::cerr << "--decode needs a loader that copies into layer slots, the "
+                 "zero-copy loader computes from the page cache"
+              << std::endl;
+    return false;
+  }
+  size_t packed = 0;
+  size_t decoded = 0;
+  for (int i = 0; i < num_layers; ++i) {
+    dequant_layouts.emplace_back(weights_index.layer(i), layer_stream_size(i),
+                                 decode_dtype);
+    packed += layer_stream_size(i);
+    decoded += dequant_layouts.back().size();
+  }
+  if (staged_decode())
+    printf("Decode : Q4 to %s in a stage of %zu threads, %zu bytes per pass "
+           "unpacked into %zu\n",
+           nntrainer::dtypeName(decode_dtype), decode_threads, packed,
+           decoded);
+  else
+    printf("Decode : Q4 to %s on the loader workers, %zu bytes per pass "
+           "unpacked into %zu\n",
+           nntrainer::dtypeName(decode_dtype), packed, decoded);
+  return true;
+}
+
+bool init_compression() {
+  if (!weights_index.compressed()) return true;
+  if (loader_mode == LoaderMode::ZERO_COPY) {
+    std::cerr << "A compressed container needs a loader that copies into "
+                 "layer slots, the zero-copy loader computes from the page "
+                 "cache"
+              << std::endl;
+    return false;
+  }
+  if (loader_mode == LoaderMode::URING) {
+    // the ring reads into slots, blocks are inflated from a bounce buffer
+    std::cerr << "io_uring can not inflate blocks, using the direct loader"
+              << std::endl;
+    loader_mode = LoaderMode::DIRECT;
+  }
+
+  size_t raw = 0;
+  size_t stored = 0;
+  for (const auto &block : weights_index.blocks()) {
+    raw += block.size;
+    stored += block.stored_size;
+  }
+  printf("Compression : %zu blocks, %zu bytes stored as %zu (ratio %.3f)\n",
+         weights_index.blocks().size(), raw, stored, double(stored) / raw);
+  return true;
+}
+
+bool init_memory_budget() {
+  size_t budget = mem_budget_mb * 1024 * 1024;
+  if (cgroup_budget) {
+    size_t available = nntrainer::MemoryBudget::cgroupAvailable();
+    if (available == 0) {
+      printf("Memory budget : no cgroup memory limit, prefetch is unbounded\n");
+      return true;
+    }
+    budget = static_cast<size_t>(available * CGROUP_BUDGET_RATIO);
+  }
+  if (budget == 0) return true;
+
+  size_t largest = page_align(max_slot_size());
+  size_t cache_bytes =
+      cache_entries() * largest +
+      expert_cache_entries() * page_align(weights_index.maxExpertSize());
+  if (budget < cache_bytes + largest) {
+    std::cerr << "Memory budget of " << budget
+              << " bytes can not hold the layer and expert caches ("
+              << cache_bytes
+              << " bytes) and the largest layer (" << largest << " bytes)"
+              << std::endl;
+    return false;
+  }
+  budget -= cache_bytes;
+  memory_budget = std::make_unique<nntrainer::MemoryBudget>(budget);
+  printf("Memory budget : %zu bytes (%s, %zu layers in flight)\n", budget,
+         cgroup_budget ? "cgroup" : "--mem-budget", budget / largest);
+  return true;
+}
+
+int max_look_ahead() {
+  int depth = adaptive_look_ahead ? MAX_LOOK_AHEAD : look_ahead;
+  if (memory_budget)
+    depth = std::min<size_t>(
+        depth, memory_budget->getLimit() / page_align(max_slot_size()));
+  return std::clamp(depth, 1, num_layers);
+}
+
+// look-ahead depth the run starts with
+int initial_look_ahead(int depth_cap) {
+  return std::min(adaptive_look_ahead ? LOOK_AHEAD : look_ahead, depth_cap);
+}
 
 void preallocate_mem_pool() {
-  for (unsigned int i = 0; i < NUM_LAYERS; i++) {
-    void *ptr = nullptr;
-    posix_memalign(&ptr, 4096, LAYER_SIZE);
-    memory_pool.emplace_back(ptr);
+  size_t num_slots = std::clamp(max_look_ahead() + spare_slots, 1, num_layers);
+  if (memory_budget)
+    num_slots = std::min(num_slots,
+                         memory_budget->getLimit() / layer_footprint(0));
+  size_t slot_size = max_slot_size();
+  memory_pool = std::make_unique<nntrainer::LayerSlotPool>(
+      num_slots, slot_size, DIRECT_IO_ALIGN, slot_memory);
+  printf("Layer slots : %zu x %zu bytes (hugetlb %zu, thp %zu, 4k %zu)\n",
+         num_slots, slot_size,
+         memory_pool->countSlots(nntrainer::SlotMemory::HUGETLB),
+         memory_pool->countSlots(nntrainer::SlotMemory::THP),
+         memory_pool->countSlots(nntrainer::SlotMemory::ALIGNED));
+  // the ring only turns over the slots the look-ahead depth needs, the
+  // others stay unfaulted until the depth grows
+  memory_pool->setActive(
+      initial_look_ahead(std::min<int>(max_look_ahead(), num_slots)) +
+      spare_slots);
+
+  if (prefault_slots) {
+    auto start = std::chrono::high_resolution_clock::now();
+    memory_pool->prefault(bs_thread_pool, layer_chunk_size(slot_size));
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("Prefaulted layer slots : %f ms\n",
+           std::chrono::duration<double, std::milli>(end - start).count());
   }
+  if (lock_slots && !memory_pool->lock())
+    std::cerr << "mlock of layer slots failed: " << strerror(errno)
+              << std::endl;
+}
+
+void init_layer_cache() {
+  if (cache_mem_mb == 0) return;
+  size_t entries = cache_entries();
+  if (loader_mode == LoaderMode::ZERO_COPY) {
+    printf("Layer cache : unused, the zero-copy loader runs from the page "
+           "cache\n");
+    return;
+  }
+  if (entries == 0) {
+    std::cerr << "Layer cache of " << cache_mem_mb
+              << " MB is smaller than a layer, running without it"
+              << std::endl;
+    return;
+  }
+
+  // steps until a layer is computed again, counted from the current step
+  auto next_use = [](int layer_id) -> size_t {
+    int current = compute_step % num_layers;
+    return (layer_id - current + num_layers) % num_layers;
+  };
+  layer_cache = std::make_unique<nntrainer::LayerCache>(
+      entries, memory_pool->slotSize(), DIRECT_IO_ALIGN, cache_policy,
+      next_use, slot_memory);
+  printf("Layer cache : %zu of %d layers (%s eviction)\n", entries,
+         num_layers,
+         cache_policy == nntrainer::EvictionPolicy::LRU ? "LRU" : "next-use");
+
+  if (prefault_slots)
+    layer_cache->prefault(bs_thread_pool,
+                          layer_chunk_size(layer_cache->entrySize()));
+  if (lock_slots && !layer_cache->lock())
+    std::cerr << "mlock of layer cache failed: " << strerror(errno)
+              << std::endl;
 }
 
 void mmap_worker(void *to, void *from, size_t size) { memcpy(to, from, size); }
 
-void load_layer(int layer_id) {
-  if (layer_id >= NUM_LAYERS) return;
+void populate_range(const char *ptr, size_t size) {
+  if (madvise(const_cast<char *>(ptr), size, MADV_POPULATE_READ) == 0) return;
+
+  // kernels before 5.14 lack MADV_POPULATE_READ, fault the pages in by hand
+  for (size_t i = 0; i < size; i += DIRECT_IO_ALIGN) {
+    volatile char touch = ptr[i];
+    (void)touch;
+  }
+}
+
+// mmap flags of a range the loader copies out of
+int range_map_flags() {
+  return MAP_PRIVATE | (populate_mode == PopulateMode::MAP ? MAP_POPULATE : 0);
+}
+
+size_t load_range_mmap(size_t offset, size_t length, char *buffer,
+                       nntrainer::LayerReadyEvent &event,
+                       BS::priority_t priority,
+                       const std::atomic<bool> &cancelled,
+                       const ChunkFunc &on_chunk) {
+  size_t chunk_size = layer_chunk_size(length);
+  size_t num_chunks = (length + chunk_size - 1) / chunk_size;
+
+  void *mapped =
+      mmap(nullptr, length, PROT_READ, range_map_flags(), fd, offset);
+  if (mapped == MAP_FAILED)
+    throw std::system_error(errno, std::generic_category(), "mmap failed");
+  char *mapped_ptr = static_cast<char *>(mapped);
+  madvise(mapped_ptr, length, MADV_WILLNEED);
+  // MAP_POPULATE has read the whole range already, otherwise only the chunks
+  // that run fault theirs in; a cancelled group skips the rest
+  std::atomic<size_t> bytes_read{
+      populate_mode == PopulateMode::MAP ? length : 0};
+
+  nntrainer::TaskGroup chunks(bs_thread_pool, &cancelled);
+  event.arm(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    size_t size = std::min(chunk_size, length - i * chunk_size);
+    chunks.detach_task(
+        [=, &event, &bytes_read, &on_chunk] {
+          // the faults of this chunk overlap the copies of the others
+          if (populate_mode == PopulateMode::CHUNK) {
+            populate_range(mapped_ptr + i * chunk_size, size);
+            bytes_read += size;
+          }
+          // unpacking reads the mapping directly instead of a copy of it
+          if (on_chunk)
+            on_chunk(i * chunk_size, mapped_ptr + i * chunk_size, size);
+          else
+            nntrainer::streamCopy(buffer + i * chunk_size,
+                                  mapped_ptr + i * chunk_size, size,
+                                  copy_kernel);
+          event.chunkDone();
+        },
+        priority);
+  }
+  chunks.wait();
+
+  munmap(mapped_ptr, length);
+  return bytes_read;
+}
+
+void direct_worker(char *to, size_t size, size_t offset,
+                   std::atomic<int> &error) {
+  while (size > 0) {
+    ssize_t ret = pread(direct_fd, to, size, offset);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) {
+      error = ret < 0 ? errno : EIO;
+      return;
+    }
+    to += ret;
+    offset += ret;
+    size -= ret;
+  }
+}
+
+size_t load_range_direct(size_t offset, size_t length, char *buffer,
+                         nntrainer::LayerReadyEvent &event,
+                         BS::priority_t priority,
+                         const std::atomic<bool> &cancelled,
+                         const ChunkFunc &on_chunk) {
+  size_t chunk_size = layer_chunk_size(length);
+  size_t num_chunks = (length + chunk_size - 1) / chunk_size;
+  std::atomic<int> error{0};
+  std::atomic<size_t> bytes_read{0};
+
+  nntrainer::TaskGroup chunks(bs_thread_pool, &cancelled);
+  event.arm(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    size_t size = std::min(chunk_size, length - i * chunk_size);
+    chunks.detach_task(
+        [=, &event, &error, &bytes_read, &on_chunk] {
+          direct_worker(buffer + i * chunk_size, size, offset + i * chunk_size,
+                        error);
+          if (error == 0) bytes_read += size;
+          // unpacked while the other chunks of the layer are still in flight
+          if (on_chunk && error == 0)
+            on_chunk(i * chunk_size, buffer + i * chunk_size, size);
+          event.chunkDone();
+        },
+        priority);
+  }
+  chunks.wait();
+
+  if (error != 0)
+    throw std::system_error(error, std::generic_category(), "pread failed");
+  return bytes_read;
+}
+
+size_t load_range_zero_copy(size_t offset, size_t length,
+                            nntrainer::LayerReadyEvent &event,
+                            BS::priority_t priority,
+                            const std::atomic<bool> &cancelled) {
+  size_t chunk_size = layer_chunk_size(length);
+  size_t num_chunks = (length + chunk_size - 1) / chunk_size;
+  const char *range_ptr = mapped_weights + offset;
+  std::atomic<size_t> bytes_read{0};
+
+  madvise(const_cast<char *>(range_ptr), length, MADV_WILLNEED);
+
+  nntrainer::TaskGroup chunks(bs_thread_pool, &cancelled);
+  event.arm(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    size_t size = std::min(chunk_size, length - i * chunk_size);
+    chunks.detach_task(
+        [=, &event, &bytes_read] {
+          populate_range(range_ptr + i * chunk_size, size);
+          bytes_read += size;
+          event.chunkDone();
+        },
+        priority);
+  }
+  chunks.wait();
+  return bytes_read;
+}
+
+size_t load_range_uring(size_t offset, size_t length, char *buffer,
+                        int buf_index, nntrainer::LayerReadyEvent &event,
+                        BS::priority_t priority,
+                        const std::atomic<bool> &cancelled,
+                        const ChunkFunc &on_chunk) {
+  if (!on_chunk) {
+    event.arm(1);
+    return uring_loader
+        ->read(buffer, length, offset, buf_index,
+               [&event] { event.chunkDone(); }, priority, &cancelled)
+        .get();
+  }
+
+  // the submitter thread must keep the ring busy, the range is unpacked on
+  // the pool once it has landed while the ring reads the next layers
+  size_t bytes_read =
+      uring_loader->read(buffer, length, offset, buf_index, nullptr, priority,
+                         &cancelled)
+          .get();
+  size_t chunk_size = layer_chunk_size(length);
+  size_t num_chunks = (length + chunk_size - 1) / chunk_size;
+  nntrainer::TaskGroup chunks(bs_thread_pool, &cancelled);
+  event.arm(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    size_t size = std::min(chunk_size, length - i * chunk_size);
+    chunks.detach_task(
+        [=, &event, &on_chunk] {
+          on_chunk(i * chunk_size, buffer + i * chunk_size, size);
+          event.chunkDone();
+        },
+        priority);
+  }
+  chunks.wait();
+  return bytes_read;
+}
+
+// bounce buffer of the calling pool thread for compressed blocks
+char *block_scratch(size_t size) {
+  thread_local std::unique_ptr<char, decltype(&std::free)> scratch(nullptr,
+                                                                   &std::free);
+  thread_local size_t capacity = 0;
+  if (capacity < size) {
+    scratch.reset(static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGN, size)));
+    if (!scratch) throw std::bad_alloc();
+    capacity = size;
+  }
+  return scratch.get();
+}
+
+size_t load_range_compressed(size_t offset, size_t length, char *buffer,
+                             nntrainer::LayerReadyEvent &event,
+                             BS::priority_t priority,
+                             const std::atomic<bool> &cancelled,
+                             const ChunkFunc &on_chunk) {
+  auto [first, last] = weights_index.blockRange(offset, length);
+  const std::vector<nntrainer::BlockInfo> &blocks = weights_index.blocks();
+  std::atomic<int> error{0};
+  std::atomic<size_t> bytes_read{0};
+
+  // stored blocks are page aligned, so the mmap loader maps them in one go
+  char *mapped_ptr = nullptr;
+  size_t map_offset = blocks[first].file_offset;
+  size_t map_length =
+      blocks[last - 1].file_offset + blocks[last - 1].stored_size - map_offset;
+  if (loader_mode == LoaderMode::MMAP) {
+    void *mapped = mmap(nullptr, map_length, PROT_READ, range_map_flags(), fd,
+                        map_offset);
+    if (mapped == MAP_FAILED)
+      throw std::system_error(errno, std::generic_category(), "mmap failed");
+    mapped_ptr = static_cast<char *>(mapped);
+    bytes_read = map_length;
+  }
+
+  // one task per block, the blocks are as large as the chunks of a plain
+  // load and inflate straight into the slot
+  nntrainer::TaskGroup chunks(bs_thread_pool, &cancelled);
+  event.arm(last - first);
+  for (size_t b = first; b < last; ++b) {
+    chunks.detach_task(
+        [=, &blocks, &event, &error, &bytes_read, &on_chunk] {
+          const nntrainer::BlockInfo &block = blocks[b];
+          char *dst = buffer + (block.offset - offset);
+          const char *src = mapped_ptr + (block.file_offset - map_offset);
+          if (mapped_ptr && populate_mode == PopulateMode::CHUNK)
+            populate_range(src, block.stored_size);
+          // O_DIRECT reads stored blocks straight into the slot only where
+          // the tensor alignment keeps them page aligned, else they bounce
+          bool aligned =
+              reinterpret_cast<uintptr_t>(dst) % DIRECT_IO_ALIGN == 0 &&
+              block.size % DIRECT_IO_ALIGN == 0;
+          if (!mapped_ptr && block.codec == nntrainer::BlockCodec::NONE &&
+              aligned) {
+            direct_worker(dst, block.size, block.file_offset, error);
+            src = nullptr;
+          } else if (!mapped_ptr) {
+            char *scratch = block_scratch(page_align(block.stored_size));
+            direct_worker(scratch, page_align(block.stored_size),
+                          block.file_offset, error);
+            src = scratch;
+          }
+          if (!mapped_ptr) bytes_read += block.stored_size;
+
+          if (src && error == 0) {
+            auto start = std::chrono::steady_clock::now();
+            if (!nntrainer::decompressBlock(block, src, dst))
+              error = EBADMSG;
+            inflate_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+            inflated_bytes += block.size;
+          }
+          if (on_chunk && error == 0)
+            on_chunk(block.offset - offset, dst, block.size);
+          event.chunkDone();
+        },
+        priority);
+  }
+  chunks.wait();
+
+  if (mapped_ptr) munmap(mapped_ptr, map_length);
+  if (error != 0)
+    throw std::system_error(error, std::generic_category(),
+                            "compressed block load failed");
+  return bytes_read;
+}
+
+// reads a range of the weights file with the selected loader, returns the
+// bytes read from storage. on_chunk, if set, gets every chunk once it has
+// landed, with its offset in the range
+size_t load_range(size_t offset, size_t length, char *buffer, int buf_index,
+                  nntrainer::LayerReadyEvent &event, BS::priority_t priority,
+                  const std::atomic<bool> &cancelled,
+                  const ChunkFunc &on_chunk = nullptr) {
+  if (loader_mode == LoaderMode::ZERO_COPY)
+    return load_range_zero_copy(offset, length, event, priority, cancelled);
+  if (weights_index.compressed())
+    return load_range_compressed(offset, length, buffer, event, priority,
+                                 cancelled, on_chunk);
+  if (loader_mode == LoaderMode::URING)
+    return load_range_uring(offset, length, buffer, buf_index, event, priority,
+                            cancelled, on_chunk);
+  if (loader_mode == LoaderMode::DIRECT)
+    return load_range_direct(offset, length, buffer, event, priority,
+                             cancelled, on_chunk);
+  return load_range_mmap(offset, length, buffer, event, priority, cancelled,
+                         on_chunk);
+}
+
+void decode_chunk(int layer_id, char *dst, size_t offset, const char *src,
+                  size_t size) {
+  auto start = std::chrono::steady_clock::now();
+  dequant_layouts[layer_id].decode(offset, src, size, dst, Q4_SCALE,
+                                   gemv_isa);
+  decode_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+}
+
+int uring_buffer_index(int step, const LayerBuffer &target) {
+  if (!uring_loader->hasRegisteredBuffers()) return -1;
+  if (target.cached)
+    return static_cast<int>(memory_pool->size()) +
+           layer_cache->entryIndex(step % num_layers);
+  return memory_pool->slotIndex(step);
+}
+
+void load_layer(int step, const std::atomic<bool> &cancelled) {
+  if (step >= total_steps()) return;
+
+  int layer_id = step % num_layers;
+  const nntrainer::LayerInfo &layer = weights_index.layer(layer_id);
+  size_t chunk_size = layer_chunk_size(layer_stream_size(layer_id));
+  LayerBuffer &target = layer_buffers[layer_id];
+  target = LayerBuffer();
+
+  if (cancelled) {
+    // never started, only pass the slot turn on so the ring keeps moving
+    if (memory_pool) memory_pool->skip(step);
+    layer_events[layer_id].set();
+    ++cancelled_loads;
+    return;
+  }
 
-  size_t chunk_size = LAYER_SIZE / NUM_THREAD;
-  size_t offset = layer_offsets[layer_id];
+  if (layer_cache) {
+    target.data = static_cast<char *>(layer_cache->pin(layer_id));
+    target.cached = target.data != nullptr;
+    if (target.cached) {
+      memory_pool->skip(step);
+      printf("Cached Layer[%d]\n", layer_id);
+      layer_events[layer_id].set();
+      return;
+    }
+    // misses go straight into the cache when it admits the layer
+    if (slo_ms <= 0.0 || resident_layers[layer_id]) {
+      size_t reuse_distance = step + num_layers - compute_step;
+      target.data =
+          static_cast<char *>(layer_cache->admit(layer_id, reuse_distance));
+      target.cached = target.data != nullptr;
+    }
+    if (target.cached) memory_pool->skip(step);
+  }
+  if (!target.data && memory_pool) {
+    // waiting for compute to free a slot is not work of the read stage
+    auto wait_start = std::chrono::high_resolution_clock::now();
+    target.data = static_cast<char *>(memory_pool->acquire(step));
+    nntrainer::StagedPipeline::addBlocked(
+        std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - wait_start)
+            .count());
+  }
   auto start = std::chrono::high_resolution_clock::now();
 
-  char *mapped_ptr =
-      static_cast<char *>(mmap(nullptr, LAYER_SIZE, PROT_READ | O_DIRECT,
-                               MAP_PRIVATE | MAP_POPULATE, fd, offset));
-  madvise(mapped_ptr, LAYER_SIZE, MADV_WILLNEED);
+  ChunkFunc decode;
+  if (decoding() && !staged_decode())
+    decode = [layer_id, dst = target.data](size_t offset, const char *src,
+                                           size_t size) {
+      decode_chunk(layer_id, dst, offset, src, size);
+    };
+  // with a decode stage, compute is only told once the layer is unpacked
+  nntrainer::LayerReadyEvent read_event;
+  nntrainer::LayerReadyEvent &event =
+      staged_decode() ? read_event : layer_events[layer_id];
 
-  for (size_t i = 0; i < NUM_THREAD; ++i) {
-    bs_thread_pool.detach_task([=] {
-      memcpy(memory_pool[layer_id] + i * chunk_size,
-             mapped_ptr + i * chunk_size, chunk_size);
-    });
+  size_t bytes_read = 0;
+  try {
+    int buf_index = loader_mode == LoaderMode::URING
+                        ? uring_buffer_index(step, target)
+                        : -1;
+    bytes_read = load_range(layer.offset, layer_stream_size(layer_id),
+                            target.data + staging_offset(layer_id), buf_index,
+                            event, chunk_priority(step), cancelled, decode);
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to load Layer[" << layer_id << "] : " << e.what()
+              << std::endl;
+    if (target.cached) {
+      layer_cache->drop(layer_id);
+      target.cached = false;
+    }
+    layer_events[layer_id].set();
+    return;
+  }
+
+  if (cancelled) {
+    // a partially loaded cache entry must not be served later
+    if (target.cached) {
+      layer_cache->drop(layer_id);
+      target.cached = false;
+    }
+    layer_events[layer_id].set();
+    printf("Cancelled Layer[%d] : %zu bytes wasted\n", layer_id, bytes_read);
+    ++cancelled_loads;
+    wasted_bytes += bytes_read;
+    return;
   }
-  bs_thread_pool.wait();
 
   auto end = std::chrono::high_resolution_clock::now();
   double duration =
       std::chrono::duration<double, std::milli>(end - start).count();
-  printf("Loaded Layer[%d] : %f ms (chunk size : %d)\n", layer_id, duration,
+  printf("Loaded Layer[%d] : %f ms (chunk size : %zu)\n", layer_id, duration,
          chunk_size);
+  if (look_ahead_controller) look_ahead_controller->recordLoad(duration);
+  if (step < num_layers) {
+    layer_load_ms[layer_id] = duration;
+    layer_load_start[layer_id] = start;
+    layer_load_end[layer_id] = end;
+  }
 
   total_load_time += duration;
-  munmap(mapped_ptr, LAYER_SIZE);
+  total_bytes_loaded += bytes_read;
+  target.packed = staged_decode();
+}
+
+// decode stage, unpacks a layer the read stage left packed in its slot
+void decode_layer(int step, const std::atomic<bool> &cancelled) {
+  if (step >= total_steps()) return;
+
+  int layer_id = step % num_layers;
+  LayerBuffer &target = layer_buffers[layer_id];
+  if (!target.packed) return;
+  target.packed = false;
+
+  size_t length = layer_stream_size(layer_id);
+  size_t chunk_size = layer_chunk_size(length);
+  size_t num_chunks = (length + chunk_size - 1) / chunk_size;
+  const char *packed = target.data + staging_offset(layer_id);
+
+  nntrainer::TaskGroup chunks(bs_thread_pool, &cancelled);
+  layer_events[layer_id].arm(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    size_t size = std::min(chunk_size, length - i * chunk_size);
+    chunks.detach_task(
+        [=, &target] {
+          decode_chunk(layer_id, target.data, i * chunk_size,
+                       packed + i * chunk_size, size);
+          layer_events[layer_id].chunkDone();
+        },
+        chunk_priority(step));
+  }
+  chunks.wait();
+
+  if (cancelled) {
+    // a partially unpacked cache entry must not be served later
+    if (target.cached) {
+      layer_cache->drop(layer_id);
+      target.cached = false;
+    }
+    layer_events[layer_id].set();
+  }
+}
+
+const char *layer_weights(int layer_id) {
+  if (loader_mode == LoaderMode::ZERO_COPY)
+    return mapped_weights + weights_index.layer(layer_id).offset;
+  return layer_buffers[layer_id].data;
+}
+
+void release_layer(int step) {
+  int layer_id = step % num_layers;
+  if (layer_buffers[layer_id].cached)
+    layer_cache->unpin(layer_id);
+  else if (memory_pool)
+    memory_pool->release(step);
+  if (!memory_budget) return;
+
+  if (loader_mode == LoaderMode::ZERO_COPY) {
+    // the page cache of the mapping is charged to our cgroup, drop it
+    const nntrainer::LayerInfo &layer = weights_index.layer(layer_id);
+    madvise(const_cast<char *>(mapped_weights + layer.offset), layer.size,
+            MADV_DONTNEED);
+    posix_fadvise(fd, layer.offset, layer.size, POSIX_FADV_DONTNEED);
+  }
+  memory_budget->release(layer_footprint(layer_id));
+}
+
+void load_expert(int key, const std::atomic<bool> &cancelled) {
+  int layer_id = key / num_experts;
+  int expert_id = key % num_experts;
+  const nntrainer::LayerInfo &layer = weights_index.layer(layer_id);
+  const nntrainer::ExpertInfo &expert = layer.experts[expert_id];
+  size_t offset = layer.offset + expert.offset;
+  char *buffer = nullptr;
+
+  if (expert_cache) {
+    buffer = static_cast<char *>(expert_cache->pin(key));
+    if (buffer) {
+      expert_buffers[key] = buffer;
+      expert_events[key].set();
+      return;
+    }
+    buffer = static_cast<char *>(expert_cache->admit(key, 0));
+    if (!buffer) {
+      std::cerr << "No free expert cache entry for Layer[" << layer_id
+                << "] Expert[" << expert_id << "]" << std::endl;
+      expert_events[key].set();
+      return;
+    }
+  }
+  expert_buffers[key] = buffer ? buffer : mapped_weights + offset;
+
+  size_t bytes_read = 0;
+  try {
+    bytes_read = load_range(offset, expert.size, buffer, -1,
+                            expert_events[key], BS::pr::highest, cancelled);
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to load Layer[" << layer_id << "] Expert["
+              << expert_id << "] : " << e.what() << std::endl;
+    if (expert_cache) expert_cache->drop(key);
+    expert_events[key].set();
+    return;
+  }
+  ++expert_loads;
+  expert_bytes_loaded += bytes_read;
+  total_bytes_loaded += bytes_read;
+}
+
+void init_expert_streaming() {
+  if (!expert_streaming) return;
+  expert_prefetcher = std::make_unique<nntrainer::PrefetchEngine>(
+      experts_per_token, load_expert);
+  if (loader_mode == LoaderMode::ZERO_COPY) return;
+
+  size_t entries = expert_cache_entries();
+  expert_cache = std::make_unique<nntrainer::LayerCache>(
+      entries, weights_index.maxExpertSize(), DIRECT_IO_ALIGN,
+      nntrainer::EvictionPolicy::LRU, nullptr, slot_memory);
+  printf("Expert cache : %zu of %d experts (LRU eviction)\n", entries,
+         num_layers * num_experts);
+
+  if (prefault_slots)
+    expert_cache->prefault(bs_thread_pool,
+                           layer_chunk_size(expert_cache->entrySize()));
+  if (lock_slots && !expert_cache->lock())
+    std::cerr << "mlock of expert cache failed: " << strerror(errno)
+              << std::endl;
+}
+
+// stands in for the router: a few experts of every layer are picked far more
+// often than the rest, and the favourites differ from layer to layer
+std::vector<int> route_experts(int layer_id) {
+  int experts = static_cast<int>(weights_index.layer(layer_id).experts.size());
+  int k = std::min(experts_per_token, experts);
+  std::vector<double> popularity(experts);
+  for (int e = 0; e < experts; ++e)
+    popularity[e] = 1.0 / (1 + (e + layer_id) % experts);
+
+  std::vector<int> chosen;
+  while (static_cast<int>(chosen.size()) < k) {
+    std::discrete_distribution<int> pick(popularity.begin(), popularity.end());
+    int expert = pick(router_rng);
+    popularity[expert] = 0.0;
+    chosen.push_back(expert);
+  }
+  return chosen;
+}
+
+// issued as soon as the router of a layer has picked its experts
+std::vector<nntrainer::PrefetchHandle>
+prefetch_experts(int layer_id, const std::vector<int> &experts) {
+  std::vector<nntrainer::PrefetchHandle> handles;
+  for (int expert : experts) {
+    int key = layer_id * num_experts + expert;
+    expert_events[key].reset();
+    handles.push_back(expert_prefetcher->prefetch(key));
+  }
+  return handles;
+}
+
+void init_compute() {
+  nntrainer::GemvIsa best = nntrainer::detectGemvIsa();
+  if (auto_gemv_isa || gemv_isa > best) {
+    if (!auto_gemv_isa)
+      std::cerr << nntrainer::gemvIsaName(gemv_isa)
+                << " is not supported by this CPU, using "
+                << nntrainer::gemvIsaName(best) << std::endl;
+    gemv_isa = best;
+  }
+
+  size_t max_rows = 0;
+  for (size_t l = 0; l < weights_index.numLayers(); ++l)
+    for (const auto &tensor : weights_index.layer(l).tensors) {
+      max_cols = std::max<size_t>(max_cols, tensor.cols);
+      max_rows = std::max<size_t>(max_rows, tensor.rows);
+    }
+  size_t max_tokens = max_batch * prompt_tokens;
+  std::mt19937 rng(ROUTER_SEED);
+  std::normal_distribution<float> normal;
+  activations.resize(max_tokens * max_cols);
+  for (auto &x : activations) x = normal(rng);
+  outputs.resize(max_tokens * max_rows);
+  printf("Compute : int4 GEMV/GEMM, %s kernels, up to %d threads\n",
+         nntrainer::gemvIsaName(gemv_isa),
+         std::max(1u, std::thread::hardware_concurrency()));
 }
 
-void compute_layer(int layer_id) {
+// data holds the tensor as dtype, Q4 or what the loader unpacked it into
+void compute_tensor(const nntrainer::TensorInfo &tensor, const char *data,
+                    nntrainer::DType dtype, size_t tokens) {
+  // norms are negligible and the embedding table is looked up, not multiplied
+  if (tensor.dtype != nntrainer::DType::Q4 || tensor.name == "tok_embd")
+    return;
+  if (dtype == nntrainer::DType::F16 || dtype == nntrainer::DType::BF16) {
+    nntrainer::gemmF16Parallel(reinterpret_cast<const uint16_t *>(data), dtype,
+                               tensor.rows, tensor.cols, activations.data(),
+                               max_cols, tokens, outputs.data(), gemv_isa);
+    return;
+  }
+
+  quantized.resize(tokens);
+  for (size_t m = 0; m < tokens; ++m)
+    nntrainer::quantizeActivation(activations.data() + m * max_cols,
+                                  tensor.cols, quantized[m]);
+  if (dtype == nntrainer::DType::I8)
+    nntrainer::gemmI8Parallel(reinterpret_cast<const int8_t *>(data),
+                              tensor.rows, tensor.cols, quantized, Q4_SCALE,
+                              outputs.data(), gemv_isa);
+  else
+    nntrainer::gemmQ4Parallel(reinterpret_cast<const uint8_t *>(data),
+                              tensor.rows, tensor.cols, quantized, Q4_SCALE,
+                              outputs.data(), gemv_isa);
+}
+
+// a tensor of a layer as load_layer left it in weights
+void compute_loaded_tensor(int layer_id, const char *weights, size_t index,
+                           size_t tokens) {
+  const nntrainer::TensorInfo &tensor =
+      weights_index.layer(layer_id).tensors[index];
+  if (!decoding()) {
+    compute_tensor(tensor, weights + tensor.offset, tensor.dtype, tokens);
+    return;
+  }
+  const nntrainer::DequantLayout &layout = dequant_layouts[layer_id];
+  compute_tensor(tensor, weights + layout.offset(index), layout.dtype(index),
+                 tokens);
+}
+
+void compute_layer(int layer_id, size_t tokens) {
+  auto wait_start = std::chrono::high_resolution_clock::now();
+  layer_events[layer_id].wait();
   auto start = std::chrono::high_resolution_clock::now();
 
-  std::this_thread::sleep_for(std::chrono::duration<double>(COMPUTE_TIME));
+  // the load picks the slot, it is only known once the layer is ready
+  const char *weights = layer_weights(layer_id);
+
+  const nntrainer::LayerInfo &layer = weights_index.layer(layer_id);
+  for (size_t i = 0; i < layer.tensors.size(); ++i)
+    if (layer.tensors[i].expert < 0)
+      compute_loaded_tensor(layer_id, weights, i, tokens);
 
   auto end = std::chrono::high_resolution_clock::now();
+  double stall =
+      std::chrono::duration<double, std::milli>(start - wait_start).count();
   double duration =
       std::chrono::duration<double, std::milli>(end - start).count();
 
-  printf("Computed Layer[%d] : %f ms \n", layer_id, duration);
+  printf("Computed Layer[%d] : %f ms (stall : %f ms)\n", layer_id, duration,
+         stall);
   total_compute_time += duration;
+  total_stall_time += stall;
+  if (look_ahead_controller)
+    look_ahead_controller->recordCompute(duration, stall);
+}
+
+void compute_experts(int layer_id) {
+  const nntrainer::LayerInfo &layer = weights_index.layer(layer_id);
+  if (layer.experts.empty()) return;
+  std::vector<int> experts = route_experts(layer_id);
+  std::vector<nntrainer::PrefetchHandle> handles;
+  if (expert_streaming) handles = prefetch_experts(layer_id, experts);
+
+  // the first expert computes while the others are still loading
+  double stall = 0.0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int expert : experts) {
+    auto wait_start = std::chrono::high_resolution_clock::now();
+    if (expert_streaming)
+      expert_events[layer_id * num_experts + expert].wait();
+    stall += std::chrono::duration<double, std::milli>(
+                 std::chrono::high_resolution_clock::now() - wait_start)
+                 .count();
+    // streamed expert weights start at the expert, not at the layer, and
+    // are never unpacked
+    size_t base = layer.experts[expert].offset;
+    for (size_t i = 0; i < layer.tensors.size(); ++i) {
+      const nntrainer::TensorInfo &tensor = layer.tensors[i];
+      if (tensor.expert != expert) continue;
+      if (expert_streaming)
+        compute_tensor(tensor,
+                       expert_buffers[layer_id * num_experts + expert] +
+                           (tensor.offset - base),
+                       tensor.dtype, 1);
+      else
+        compute_loaded_tensor(layer_id, layer_weights(layer_id), i, 1);
+    }
+  }
+  for (auto &handle : handles) handle.wait();
+  if (expert_cache)
+    for (int expert : experts)
+      expert_cache->unpin(layer_id * num_experts + expert);
+  auto end = std::chrono::high_resolution_clock::now();
+  double duration =
+      std::chrono::duration<double, std::milli>(end - start).count() - stall;
+
+  std::string chosen;
+  for (int expert : experts) chosen += " " + std::to_string(expert);
+  printf("Computed Experts[%d] :%s : %f ms (stall : %f ms)\n", layer_id,
+         chosen.c_str(), duration, stall);
+  total_compute_time += duration;
+  total_stall_time += stall;
+}
+
+void plan_residency(int depth) {
+  // only layers the first pass finished loading were timed, an early exit
+  // cancels the others
+  using TimePoint = std::chrono::high_resolution_clock::time_point;
+  std::vector<int> loaded;
+  for (int i = 0; i < num_layers; ++i)
+    if (layer_load_end[i] != TimePoint{}) loaded.push_back(i);
+  if (loaded.empty()) {
+    printf("Residency plan : no layer loaded in the first pass, not planned\n");
+    return;
+  }
+
+  // loads overlap on the I/O threads, scale their latencies to storage time
+  TimePoint first = layer_load_start[loaded.front()];
+  TimePoint last = layer_load_end[loaded.front()];
+  double latency_ms = 0.0;
+  for (int i : loaded) {
+    first = std::min(first, layer_load_start[i]);
+    last = std::max(last, layer_load_end[i]);
+    latency_ms += layer_load_ms[i];
+  }
+  double io_ms =
+      std::chrono::duration<double, std::milli>(last - first).count();
+  double scale = io_ms / std::max(latency_ms, 1e-9);
+  // layers that were never timed are assumed to load like the average one
+  std::vector<double> load_ms(num_layers, latency_ms / loaded.size() * scale);
+  for (int i : loaded) load_ms[i] = layer_load_ms[i] * scale;
+  if (loaded.size() < static_cast<size_t>(num_layers))
+    printf("Residency plan : %zu of %d layers timed, the others are assumed "
+           "average\n",
+           loaded.size(), num_layers);
+
+  size_t entry_size = page_align(max_slot_size());
+  size_t budget = layer_cache ? layer_cache->size() * entry_size : 0;
+  nntrainer::ResidencyPlanner planner(depth, continuous_decode);
+  nntrainer::ResidencyPlan plan = planner.plan(
+      load_ms, std::vector<size_t>(num_layers, entry_size),
+      total_compute_time / num_layers, slo_ms, budget);
+  for (int i = 0; i < num_layers; ++i) resident_layers[i] = plan.resident[i];
+
+  std::string layers;
+  for (int i = 0; i < num_layers; ++i)
+    if (plan.resident[i]) layers += " " + std::to_string(i);
+  size_t resident = plan.resident_bytes / entry_size;
+  printf("Residency plan : %zu resident, %zu streamed, predicted %f ms per "
+         "token (%f tokens/s), target %f ms %s\n",
+         resident, num_layers - resident, plan.predicted_token_ms,
+         1000.0 / plan.predicted_token_ms, slo_ms,
+         plan.meets_target ? "met" : "not met");
+  printf("Resident layers :%s\n", layers.empty() ? " none" : layers.c_str());
+}
+
+bool parse_args(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg.rfind("--weights=", 0) == 0) {
+      weights_file = arg.substr(strlen("--weights="));
+    } else if (arg == "--loader=mmap") {
+      loader_mode = LoaderMode::MMAP;
+    } else if (arg == "--loader=direct") {
+      loader_mode = LoaderMode::DIRECT;
+    } else if (arg == "--loader=uring") {
+      loader_mode = LoaderMode::URING;
+    } else if (arg == "--loader=zerocopy") {
+      loader_mode = LoaderMode::ZERO_COPY;
+    } else if (arg == "--populate=map") {
+      populate_mode = PopulateMode::MAP;
+    } else if (arg == "--populate=chunk") {
+      populate_mode = PopulateMode::CHUNK;
+    } else if (arg.rfind("--queue-depth=", 0) == 0) {
+      uring_queue_depth = std::stoul(arg.substr(strlen("--queue-depth=")));
+    } else if (arg.rfind("--io-threads=", 0) == 0) {
+      io_threads = std::stoul(arg.substr(strlen("--io-threads=")));
+    } else if (arg == "--lookahead=auto") {
+      adaptive_look_ahead = true;
+    } else if (arg.rfind("--lookahead=", 0) == 0) {
+      look_ahead = std::max(1, std::stoi(arg.substr(strlen("--lookahead="))));
+      adaptive_look_ahead = false;
+    } else if (arg == "--mem-budget=auto") {
+      cgroup_budget = true;
+    } else if (arg.rfind("--mem-budget=", 0) == 0) {
+      mem_budget_mb = std::stoul(arg.substr(strlen("--mem-budget=")));
+      cgroup_budget = false;
+    } else if (arg.rfind("--tokens=", 0) == 0) {
+      num_tokens = std::max(1, std::stoi(arg.substr(strlen("--tokens="))));
+    } else if (arg.rfind("--requests=", 0) == 0) {
+      num_requests = std::max(1, std::stoi(arg.substr(strlen("--requests="))));
+    } else if (arg.rfind("--arrival-ms=", 0) == 0) {
+      arrival_ms = std::stod(arg.substr(strlen("--arrival-ms=")));
+    } else if (arg.rfind("--prompt=", 0) == 0) {
+      prompt_tokens = std::max(1, std::stoi(arg.substr(strlen("--prompt="))));
+    } else if (arg.rfind("--batch=", 0) == 0) {
+      max_batch = std::max(1, std::stoi(arg.substr(strlen("--batch="))));
+    } else if (arg.rfind("--batch-timeout=", 0) == 0) {
+      batch_timeout_ms = std::stod(arg.substr(strlen("--batch-timeout=")));
+    } else if (arg.rfind("--cache-mem=", 0) == 0) {
+      cache_mem_mb = std::stoul(arg.substr(strlen("--cache-mem=")));
+    } else if (arg == "--cache-policy=lru") {
+      cache_policy = nntrainer::EvictionPolicy::LRU;
+    } else if (arg == "--cache-policy=next-use") {
+      cache_policy = nntrainer::EvictionPolicy::NEXT_USE;
+    } else if (arg.rfind("--early-exit=", 0) == 0) {
+      early_exit_layer = std::stoi(arg.substr(strlen("--early-exit=")));
+    } else if (arg.rfind("--experts-per-token=", 0) == 0) {
+      experts_per_token =
+          std::max(1, std::stoi(arg.substr(strlen("--experts-per-token="))));
+    } else if (arg.rfind("--expert-cache=", 0) == 0) {
+      expert_cache_mb = std::stoul(arg.substr(strlen("--expert-cache=")));
+    } else if (arg == "--expert-streaming=on") {
+      stream_experts = true;
+    } else if (arg == "--expert-streaming=off") {
+      stream_experts = false;
+    } else if (arg == "--continuous") {
+      continuous_decode = true;
+    } else if (arg.rfind("--slo=", 0) == 0) {
+      slo_ms = std::stod(arg.substr(strlen("--slo=")));
+    } else if (arg.rfind("--spare-slots=", 0) == 0) {
+      spare_slots = std::stoi(arg.substr(strlen("--spare-slots=")));
+    } else if (arg == "--hugepages=off") {
+      slot_memory = nntrainer::SlotMemory::ALIGNED;
+    } else if (arg == "--hugepages=thp") {
+      slot_memory = nntrainer::SlotMemory::THP;
+    } else if (arg == "--hugepages=hugetlb") {
+      slot_memory = nntrainer::SlotMemory::HUGETLB;
+    } else if (arg == "--kernel=auto") {
+      auto_gemv_isa = true;
+    } else if (arg == "--kernel=scalar") {
+      gemv_isa = nntrainer::GemvIsa::SCALAR;
+      auto_gemv_isa = false;
+    } else if (arg == "--kernel=avx2") {
+      gemv_isa = nntrainer::GemvIsa::AVX2;
+      auto_gemv_isa = false;
+    } else if (arg == "--kernel=avx512") {
+      gemv_isa = nntrainer::GemvIsa::AVX512;
+      auto_gemv_isa = false;
+    } else if (arg == "--decode=off") {
+      decode_dtype = nntrainer::DType::Q4;
+    } else if (arg == "--decode=i8") {
+      decode_dtype = nntrainer::DType::I8;
+    } else if (arg == "--decode=f16") {
+      decode_dtype = nntrainer::DType::F16;
+    } else if (arg == "--decode=bf16") {
+      decode_dtype = nntrainer::DType::BF16;
+    } else if (arg.rfind("--decode-threads=", 0) == 0) {
+      decode_threads = std::stoul(arg.substr(strlen("--decode-threads=")));
+    } else if (arg.rfind("--decode-queue=", 0) == 0) {
+      decode_queue = std::stoul(arg.substr(strlen("--decode-queue=")));
+    } else if (arg == "--copy=auto") {
+      auto_copy_kernel = true;
+    } else if (arg == "--copy=memcpy") {
+      copy_kernel = nntrainer::CopyKernel::MEMCPY;
+      auto_copy_kernel = false;
+    } else if (arg == "--copy=movsb") {
+      copy_kernel = nntrainer::CopyKernel::REP_MOVSB;
+      auto_copy_kernel = false;
+    } else if (arg == "--copy=avx2") {
+      copy_kernel = nntrainer::CopyKernel::AVX2_STREAM;
+      auto_copy_kernel = false;
+    } else if (arg == "--copy=avx512") {
+      copy_kernel = nntrainer::CopyKernel::AVX512_STREAM;
+      auto_copy_kernel = false;
+    } else if (arg == "--prefault") {
+      prefault_slots = true;
+    } else if (arg == "--mlock") {
+      lock_slots = true;
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      std::cerr << "Usage: " << argv[0]
+                << " [--weights=PATH] [--loader=mmap|direct|uring|zerocopy]"
+                << " [--populate=map|chunk] [--queue-depth=N]"
+                << " [--io-threads=N] [--lookahead=N|auto] [--mem-budget=MB|auto]"
+                << " [--tokens=N] [--requests=N] [--arrival-ms=MS]"
+                << " [--batch=N] [--batch-timeout=MS] [--prompt=N]"
+                << " [--continuous] [--early-exit=N]"
+                << " [--cache-mem=MB]"
+                << " [--cache-policy=lru|next-use] [--slo=MS]"
+                << " [--experts-per-token=N] [--expert-cache=MB]"
+                << " [--expert-streaming=on|off]"
+                << " [--spare-slots=N] [--kernel=auto|scalar|avx2|avx512]"
+                << " [--decode=off|i8|f16|bf16] [--decode-threads=N]"
+                << " [--decode-queue=N] [--copy=auto|memcpy|movsb|avx2|avx512]"
+                << " [--hugepages=off|thp|hugetlb] [--prefault] [--mlock]" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+void init_copy_kernel() {
+  if (auto_copy_kernel) {
+    copy_kernel = nntrainer::detectCopyKernel();
+  } else if (!nntrainer::copyKernelSupported(copy_kernel)) {
+    std::cerr << nntrainer::copyKernelName(copy_kernel)
+              << " copies are not supported by this CPU, using memcpy"
+              << std::endl;
+    copy_kernel = nntrainer::CopyKernel::MEMCPY;
+  }
+  if (loader_mode == LoaderMode::MMAP)
+    printf("Copy : %s chunks into the layer slots\n",
+           nntrainer::copyKernelName(copy_kernel));
+}
+
+void init_uring_loader() {
+  try {
+    uring_loader = std::make_unique<nntrainer::UringLoader>(
+        direct_fd, uring_queue_depth,
+        layer_chunk_size(max_stream_size()));
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << ", falling back to mmap loader" << std::endl;
+    loader_mode = LoaderMode::MMAP;
+    return;
+  }
+
+  std::vector<void *> buffers = memory_pool->buffers();
+  if (layer_cache)
+    buffers.insert(buffers.end(), layer_cache->buffers().begin(),
+                   layer_cache->buffers().end());
+  if (!uring_loader->registerBuffers(buffers, memory_pool->slotSize()))
+    std::cerr << "io_uring buffer registration failed: " << strerror(errno)
+              << ", using unregistered reads" << std::endl;
+  else
+    // the ring pinned every slot page, reads would land in dropped pages
+    memory_pool->keepResident();
+}
+
+bool map_weights() {
+  void *mapped = mmap(nullptr, weights_index.fileSize(), PROT_READ,
+                      MAP_SHARED, fd, 0);
+  if (mapped == MAP_FAILED) {
+    std::cerr << "Failed to map " << weights_file << " : " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+  mapped_weights = static_cast<const char *>(mapped);
+  printf("Zero-copy mapping : %zu bytes\n", weights_index.fileSize());
+  return true;
 }
 
 int main(int argc, char *argv[]) {
-  fd = open(WEIGHTS_FILE.c_str(), O_RDONLY | O_DIRECT);
-  for (int i = 0; i < NUM_LAYERS; ++i) {
-    layer_offsets.emplace_back(static_cast<size_t>(i) * LAYER_SIZE);
+  if (!parse_args(argc, argv)) return 1;
+
+  fd = open(weights_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Failed to open " << weights_file << " : " << strerror(errno)
+              << std::endl;
+    return 1;
   }
+  if (!load_weights_index()) return 1;
+  if (!init_compression()) return 1;
+  if (!init_dequant()) return 1;
+  if (!init_memory_budget()) return 1;
 
-  preallocate_mem_pool();
+  if (loader_mode == LoaderMode::DIRECT || loader_mode == LoaderMode::URING) {
+    direct_fd = open(weights_file.c_str(), O_RDONLY | O_DIRECT);
+    if (direct_fd < 0) {
+      std::cerr << "O_DIRECT open failed: " << strerror(errno)
+                << ", reading through the page cache" << std::endl;
+      direct_fd = fd;
+    }
+  }
+
+  if (loader_mode == LoaderMode::ZERO_COPY) {
+    if (!map_weights()) return 1;
+  } else {
+    preallocate_mem_pool();
+  }
+  init_layer_cache();
+  init_expert_streaming();
+  init_compute();
+  if (loader_mode == LoaderMode::URING) init_uring_loader();
+  init_copy_kernel();
+  std::vector<nntrainer::StagedPipeline::Stage> stages = {
+      {"read", io_threads, 0, load_layer}};
+  if (staged_decode())
+    stages.push_back({"decode", decode_threads, decode_queue, decode_layer});
+  load_pipeline = std::make_unique<nntrainer::StagedPipeline>(
+      std::move(stages), "compute");
 
   auto program_start = std::chrono::high_resolution_clock::now();
 
-  for (int i = 0; i < LOOK_AHEAD; ++i) {
-    load_futures.push_back(std::async(std::launch::async, load_layer, i));
+  int depth_cap = max_look_ahead();
+  if (memory_pool)
+    depth_cap = std::min(depth_cap, static_cast<int>(memory_pool->size()));
+  int depth = initial_look_ahead(depth_cap);
+  if (adaptive_look_ahead) {
+    look_ahead_controller = std::make_unique<nntrainer::LookaheadController>(
+        depth, 1, depth_cap);
+    depth = look_ahead_controller->getDepth();
   }
 
-  for (unsigned int order = 0; order < NUM_LAYERS; ++order) {
-    compute_layer(order);
-    load_futures.push_back(
-        std::async(std::launch::async, load_layer, order + LOOK_AHEAD));
+  std::deque<nntrainer::PrefetchHandle> pending_loads;
+  int next_prefetch = 0;
+  // steps before this one belong to a pass that already exited early
+  int cancel_until = 0;
+  auto issue_prefetches = [&](int limit) {
+    for (; next_prefetch < limit && next_prefetch < total_steps();
+         ++next_prefetch) {
+      int layer_id = next_prefetch % num_layers;
+      // slot loaders never exceed the budget, the slot count is cut to it;
+      // the zero-copy loader has no slots and is held back here
+      if (memory_budget &&
+          !memory_budget->tryReserve(layer_footprint(layer_id)))
+        break;
+      layer_events[layer_id].reset();
+      pending_loads.push_back(load_pipeline->submit(next_prefetch));
+      if (next_prefetch < cancel_until) pending_loads.back().cancel();
+    }
+  };
+  issue_prefetches(depth);
+
+  // requests arrive on their own thread, every batch of them runs num_tokens
+  // passes and each loaded layer is computed once per request of the batch
+  nntrainer::RequestBatcher batcher(
+      max_batch, std::chrono::duration<double, std::milli>(batch_timeout_ms));
+  std::thread arrivals([&batcher] {
+    for (int i = 0; i < num_requests; ++i) {
+      if (i > 0 && arrival_ms > 0.0)
+        std::this_thread::sleep_for(
+            std::chrono::duration<double, std::milli>(arrival_ms));
+      batcher.submit(i);
+    }
+    batcher.close();
+  });
+  std::vector<nntrainer::InferenceRequest> batch;
+  int batch_passes = num_tokens;
+  int passes = 0;
+  double total_latency_ms = 0.0;
+  auto finish_batch = [&] {
+    auto now = std::chrono::steady_clock::now();
+    for (const auto &request : batch)
+      total_latency_ms +=
+          std::chrono::duration<double, std::milli>(now - request.arrival)
+              .count();
+  };
+
+  auto token_start = program_start;
+  size_t token_bytes_start = 0;
+  for (int order = 0; order < total_steps(); ++order) {
+    int layer_id = order % num_layers;
+    if (layer_id == 0 && batch_passes == num_tokens) {
+      finish_batch();
+      batch = batcher.nextBatch();
+      if (batch.empty()) break;
+      batch_passes = 0;
+      if (num_requests > 1)
+        printf("Batch[%zu] : %zu requests\n", batcher.getBatches() - 1,
+               batch.size());
+    }
+
+    bool exited = early_exit_layer >= 0 && layer_id > early_exit_layer;
+    compute_step = order;
+    double compute_before = total_compute_time;
+    double layer_stall = 0.0;
+    load_pipeline->beginConsume(pending_loads.front());
+    if (!exited) {
+      // the dense part runs once for every token of the batch, the router
+      // picks experts per token
+      size_t tokens = batch.size() * (batch_passes == 0 ? prompt_tokens : 1);
+      double stall_before = total_stall_time;
+      compute_layer(layer_id, tokens);
+      layer_stall = total_stall_time - stall_before;
+      for (size_t i = 0; i < tokens; ++i) compute_experts(layer_id);
+    }
+    load_pipeline->endConsume(total_compute_time - compute_before,
+                              layer_stall);
+    pending_loads.front().wait();
+    pending_loads.pop_front();
+    if (layer_id == early_exit_layer) {
+      // the pass is done, the loads of its remaining layers are not needed
+      cancel_until = (order / num_layers + 1) * num_layers;
+      for (auto &handle : pending_loads)
+        if (handle.layer() < cancel_until) handle.cancel();
+    }
+    release_layer(order);
+    if (look_ahead_controller) {
+      int new_depth = static_cast<int>(look_ahead_controller->update());
+      if (new_depth != depth) {
+        printf("Look-ahead : %d -> %d layers\n", depth, new_depth);
+        if (memory_pool) memory_pool->setActive(new_depth + spare_slots);
+      }
+      depth = new_depth;
+    }
+    // the first pass measures the loads the residency plan is built from
+    if (slo_ms > 0.0 && order == num_layers - 1) plan_residency(depth);
+
+    // without continuous decode the next forward pass is only prefetched
+    // once this one is done; with it the tail of a pass overlaps the loads of
+    // the next pass' first layers
+    int limit = order + 1 + depth;
+    if (!continuous_decode)
+      limit = std::min(limit, ((order + 1) / num_layers + 1) * num_layers);
+    issue_prefetches(limit);
+
+    if (layer_id == num_layers - 1) {
+      ++batch_passes;
+      ++passes;
+      auto token_end = std::chrono::high_resolution_clock::now();
+      size_t bytes = total_bytes_loaded;
+      printf("Token[%d] : %f ms, %zu bytes read\n", order / num_layers,
+             std::chrono::duration<double, std::milli>(token_end - token_start)
+                 .count(),
+             bytes - token_bytes_start);
+      token_start = token_end;
+      token_bytes_start = bytes;
+    }
+  }
+  finish_batch();
+  arrivals.join();
+
+  // passes prefetched for requests that never came
+  for (auto &handle : pending_loads) handle.cancel();
+  for (auto &handle : pending_loads) {
+    handle.wait();
+    release_layer(handle.layer());
   }
 
   auto program_end = std::chrono::high_resolution_clock::now();
@@ -116,12 +1607,89 @@ int main(int argc, char *argv[]) {
   std::cout << "Total loading time: " << total_load_time << " ms" << std::endl;
   std::cout << "Total compute time: " << total_compute_time << " ms"
             << std::endl;
+  std::cout << "Total stall time: " << total_stall_time << " ms" << std::endl;
   std::cout << "Total Forwarding execution time: " << program_duration << " ms"
             << std::endl;
-
-  for (auto ptr : memory_pool) {
-    if (ptr) free(ptr);
+  std::cout << "Look-ahead depth: " << depth << " (max " << depth_cap << ")"
+            << std::endl;
+  std::cout << "Total bytes read: " << total_bytes_loaded << " ("
+            << total_bytes_loaded / std::max(passes, 1) << " per pass)"
+            << std::endl;
+  if (num_requests > 1)
+    std::cout << "Requests: " << num_requests << " in "
+              << batcher.getBatches() << " batches, mean latency "
+              << total_latency_ms / num_requests << " ms, "
+              << total_bytes_loaded / (num_requests * num_tokens)
+              << " bytes read per request token" << std::endl;
+  if (decoding() && staged_decode())
+    std::cout << "Decode: " << decode_ns / 1e6
+              << " ms unpacking in the decode stage (" << decode_threads
+              << " threads, chunks on the thread pool)" << std::endl;
+  else if (decoding())
+    std::cout << "Decode: " << decode_ns / 1e6
+              << " ms unpacking on the loader workers" << std::endl;
+  if (weights_index.compressed())
+    std::cout << "Compression: " << inflated_bytes << " bytes inflated in "
+              << inflate_ns / 1e6 << " ms on the loader workers" << std::endl;
+  if (memory_pool)
+    std::cout << "Layer slots: " << memory_pool->getActive() << " of "
+              << memory_pool->size() << " in the ring, "
+              << memory_pool->residentBytes() << " of "
+              << memory_pool->size() * memory_pool->slotSize()
+              << " bytes resident" << std::endl;
+  if (early_exit_layer >= 0)
+    std::cout << "Cancelled loads: " << cancelled_loads << ", "
+              << wasted_bytes << " bytes read for nothing" << std::endl;
+  if (layer_cache)
+    std::cout << "Layer cache: " << layer_cache->getHits() << " hits, "
+              << layer_cache->getMisses() << " misses, "
+              << layer_cache->getEvictions() << " evictions" << std::endl;
+  if (memory_budget) {
+    std::cout << "Memory budget: peak " << memory_budget->getPeak() << " of "
+              << memory_budget->getLimit() << " bytes";
+    if (loader_mode == LoaderMode::ZERO_COPY)
+      std::cout << ", " << memory_budget->getRefused()
+                << " prefetches held back";
+    std::cout << std::endl;
   }
+  if (num_experts > 0) {
+    std::cout << "Experts: " << expert_loads << " loads, "
+              << expert_bytes_loaded << " bytes read";
+    if (expert_cache)
+      std::cout << ", cache " << expert_cache->getHits() << " hits, "
+                << expert_cache->getMisses() << " misses";
+    std::cout << std::endl;
+  }
+  // the stage the others waited on longest limits the pipeline, give it
+  // threads from the others; on a tie blame the later stage, compute last
+  std::string bottleneck;
+  double holding = -1.0;
+  for (const auto &stage : load_pipeline->getStats()) {
+    printf("Stage %s : %zu threads, %zu items, %.1f%% busy, held others "
+           "%.1f ms, queue mean %.2f max %zu",
+           stage.name.c_str(), stage.threads, stage.items,
+           100.0 * stage.utilization, stage.holding_ms, stage.mean_queue,
+           stage.max_queue);
+    if (stage.capacity > 0) printf(" of %zu", stage.capacity);
+    printf("\n");
+    if (stage.holding_ms >= holding) {
+      holding = stage.holding_ms;
+      bottleneck = stage.name;
+    }
+  }
+  std::cout << "Bottleneck stage: " << bottleneck << std::endl;
+  std::cout << "Pipeline is "
+            << (bottleneck == "read" ? std::string("I/O") : bottleneck)
+            << "-bound" << std::endl;
+
+  load_pipeline.reset();
+  expert_prefetcher.reset();
+  uring_loader.reset();
+  layer_cache.reset();
+  memory_pool.reset();
+  if (mapped_weights)
+    munmap(const_cast<char *>(mapped_weights), weights_index.fileSize());
+  if (direct_fd >= 0 && direct_fd != fd) close(direct_fd);
   close(fd);
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   memory_budget.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Memory budget for in-flight layers source file
+ */
+
+#include "memory_budget.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace nntrainer {
+
+namespace {
+// false if the file is missing or holds "max"
+bool read_cgroup_value(const std::string &path, std::size_t &value) {
+  std::ifstream file(path);
+  std::string text;
+  if (!(file >> text) || text == "max")
+    return false;
+  try {
+    value = std::stoull(text);
+  } catch (const std::exception &) {
+    return false;
+  }
+  return true;
+}
+
+// cgroup v2 group of this process relative to the hierarchy root
+std::string own_cgroup() {
+  std::ifstream file("/proc/self/cgroup");
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.rfind("0::", 0) == 0)
+      return line.substr(3);
+  }
+  return "";
+}
+} // namespace
+
+MemoryBudget::MemoryBudget(std::size_t limit) : limit(limit) {
+  if (limit == 0)
+    throw std::invalid_argument("memory budget must be positive");
+}
+
+std::size_t MemoryBudget::cgroupAvailable(const std::string &cgroup_root) {
+  std::string group = own_cgroup();
+  std::size_t available = std::numeric_limits<std::size_t>::max();
+
+  while (true) {
+    std::string dir = cgroup_root + group;
+    std::size_t max = 0;
+    std::size_t current = 0;
+    if (read_cgroup_value(dir + "/memory.max", max) &&
+        read_cgroup_value(dir + "/memory.current", current))
+      available = std::min(available, max > current ? max - current : 0);
+
+    if (group.empty() || group == "/")
+      break;
+    group = group.substr(0, group.find_last_of('/'));
+  }
+
+  if (available == std::numeric_limits<std::size_t>::max())
+    return 0;
+  return available;
+}
+
+bool MemoryBudget::tryReserve(std::size_t bytes) {
+  std::scoped_lock lock(budget_mutex);
+  if (used + bytes > limit) {
+    ++refused;
+    return false;
+  }
+  used += bytes;
+  peak = std::max(peak, used);
+  return true;
+}
+
+void MemoryBudget::release(std::size_t bytes) {
+  std::scoped_lock lock(budget_mutex);
+  used -= std::min(used, bytes);
+}
+
+std::size_t MemoryBudget::getUsed() const {
+  std::scoped_lock lock(budget_mutex);
+  return used;
+}
+
+std::size_t MemoryBudget::getPeak() const {
+  std::scoped_lock lock(budget_mutex);
+  return peak;
+}
+
+std::size_t MemoryBudget::getRefused() const {
+  std::scoped_lock lock(budget_mutex);
+  return refused;
+}
+} // namespace nntrainer
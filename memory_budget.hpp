@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   memory_budget.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Memory budget for in-flight layers header file
+ */
+
+#ifndef MEMORY_BUDGET_HPP
+#define MEMORY_BUDGET_HPP
+
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+namespace nntrainer {
+/**
+ * @brief MemoryBudget accounts the bytes held by prefetched layers. A prefetch
+ * is only issued once its bytes can be reserved, so the loader never holds
+ * more than the budget and new prefetches are held back until compute
+ * releases a layer.
+ *
+ */
+class MemoryBudget {
+public:
+  /**
+   * @brief Construct a new Memory Budget object
+   *
+   * @param limit number of bytes that may be reserved at once
+   */
+  explicit MemoryBudget(std::size_t limit);
+
+  /**
+   * @brief Read the memory still available to this process from the cgroup v2
+   * hierarchy, i.e. the smallest memory.max - memory.current of its cgroup and
+   * all of its ancestors.
+   *
+   * @param cgroup_root mount point of the cgroup v2 hierarchy
+   * @return std::size_t available bytes, 0 if no limit is set or readable
+   */
+  static std::size_t cgroupAvailable(
+    const std::string &cgroup_root = "/sys/fs/cgroup");
+
+  /**
+   * @brief Reserve bytes if they fit into the budget. Thread safe.
+   *
+   * @param bytes number of bytes to reserve
+   * @return true if reserved, false if the budget is exhausted
+   */
+  bool tryReserve(std::size_t bytes);
+
+  /**
+   * @brief Return bytes reserved with tryReserve. Thread safe.
+   *
+   * @param bytes number of bytes to release
+   */
+  void release(std::size_t bytes);
+
+  /**
+   * @brief Get the budget
+   *
+   * @return std::size_t budget in bytes
+   */
+  std::size_t getLimit() const { return limit; }
+
+  /**
+   * @brief Get the bytes reserved right now
+   *
+   * @return std::size_t reserved bytes
+   */
+  std::size_t getUsed() const;
+
+  /**
+   * @brief Get the highest number of bytes reserved at once
+   *
+   * @return std::size_t peak reserved bytes
+   */
+  std::size_t getPeak() const;
+
+  /**
+   * @brief Get how many reservations were refused
+   *
+   * @return std::size_t number of refused reservations
+   */
+  std::size_t getRefused() const;
+
+private:
+  std::size_t limit;
+  std::size_t used = 0;
+  std::size_t peak = 0;
+  std::size_t refused = 0;
+  mutable std::mutex budget_mutex;
+};
+} // namespace nntrainer
+
+#endif // MEMORY_BUDGET_HPP
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   prefetch_engine.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Long-lived layer prefetch engine source file
+ */
+
+#include "prefetch_engine.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace nntrainer {
+
+void PrefetchHandle::wait() const {
+  if (request)
+    request->done_future.get();
+}
+
+bool PrefetchHandle::isDone() const {
+  return !request || request->done_future.wait_for(std::chrono::seconds(0)) ==
+                       std::future_status::ready;
+}
+
+void PrefetchHandle::cancel() const {
+  if (request)
+    request->cancelled.store(true, std::memory_order_release);
+}
+
+bool PrefetchHandle::isCancelled() const {
+  return request && request->cancelled.load(std::memory_order_acquire);
+}
+
+int PrefetchHandle::layer() const { return request ? request->layer_id : -1; }
+
+PrefetchEngine::PrefetchEngine(std::size_t num_io_threads, LoadFunc load) :
+  load(std::move(load)) {
+  if (num_io_threads == 0)
+    throw std::invalid_argument("prefetch engine needs at least one thread");
+
+  io_threads.reserve(num_io_threads);
+  for (std::size_t i = 0; i < num_io_threads; ++i)
+    io_threads.emplace_back(&PrefetchEngine::worker, this);
+}
+
+PrefetchEngine::~PrefetchEngine() {
+  {
+    std::scoped_lock lock(queue_mutex);
+    stop = true;
+  }
+  request_available_cv.notify_all();
+  for (auto &thread : io_threads)
+    thread.join();
+}
+
+PrefetchHandle PrefetchEngine::prefetch(int layer_id) {
+  auto request = std::make_shared<PrefetchHandle::Request>();
+  request->layer_id = layer_id;
+  request->done_future = request->done.get_future().share();
+  {
+    std::scoped_lock lock(queue_mutex);
+    queue.push_back(request);
+  }
+  request_available_cv.notify_one();
+  return PrefetchHandle(std::move(request));
+}
+
+void PrefetchEngine::drain() {
+  std::unique_lock lock(queue_mutex);
+  requests_done_cv.wait(lock,
+                        [this] { return queue.empty() && running == 0; });
+}
+
+std::size_t PrefetchEngine::getPending() const {
+  std::scoped_lock lock(queue_mutex);
+  return queue.size() + running;
+}
+
+void PrefetchEngine::worker() {
+  while (true) {
+    std::shared_ptr<PrefetchHandle::Request> request;
+    {
+      std::unique_lock lock(queue_mutex);
+      request_available_cv.wait(lock,
+                                [this] { return stop || !queue.empty(); });
+      if (queue.empty())
+        break;
+      request = std::move(queue.front());
+      queue.pop_front();
+      ++running;
+    }
+
+    try {
+      load(request->layer_id, request->cancelled);
+      request->done.set_value();
+    } catch (...) {
+      request->done.set_exception(std::current_exception());
+    }
+
+    {
+      std::scoped_lock lock(queue_mutex);
+      --running;
+    }
+    requests_done_cv.notify_all();
+  }
+}
+} // namespace nntrainer
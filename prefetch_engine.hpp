@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   prefetch_engine.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Long-lived layer prefetch engine header file
+ */
+
+#ifndef PREFETCH_ENGINE_HPP
+#define PREFETCH_ENGINE_HPP
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nntrainer {
+
+class PrefetchEngine;
+class StagedPipeline;
+
+/**
+ * @brief Handle to a single "load layer N" request of a PrefetchEngine
+ *
+ */
+class PrefetchHandle {
+public:
+  /**
+   * @brief Construct an empty handle
+   *
+   */
+  PrefetchHandle() = default;
+
+  /**
+   * @brief Block until the load has finished. Rethrows the load's exception.
+   *
+   */
+  void wait() const;
+
+  /**
+   * @brief Check whether the load has finished without blocking
+   *
+   * @return true if the load has finished
+   */
+  bool isDone() const;
+
+  /**
+   * @brief Cancel the request. A request that has not started yet runs its
+   * load function with the cancel flag set, a running one sees the flag and
+   * stops early; either way the load function releases what it holds.
+   *
+   */
+  void cancel() const;
+
+  /**
+   * @brief Check whether the request was cancelled
+   *
+   * @return true if cancel() was called
+   */
+  bool isCancelled() const;
+
+  /**
+   * @brief Get the layer this request loads
+   *
+   * @return int layer id, or -1 for an empty handle
+   */
+  int layer() const;
+
+  /**
+   * @brief Check whether the handle refers to a request
+   *
+   */
+  explicit operator bool() const { return request != nullptr; }
+
+private:
+  friend class PrefetchEngine;
+  friend class StagedPipeline;
+
+  /**
+   * @brief Request state shared by the engine and the handle
+   *
+   */
+  struct Request {
+    int layer_id;
+    std::atomic<bool> cancelled{false};
+    std::promise<void> done;
+    std::shared_future<void> done_future;
+    bool consumed = false; /**< taken by the consumer of a StagedPipeline */
+    std::size_t stage = 0; /**< StagedPipeline stage holding the request */
+    std::chrono::steady_clock::time_point stage_start; /**< when that stage
+                                                          started on it */
+  };
+
+  explicit PrefetchHandle(std::shared_ptr<Request> request) :
+    request(std::move(request)) {}
+
+  std::shared_ptr<Request> request;
+};
+
+/**
+ * @brief PrefetchEngine owns a small fixed set of I/O threads and a FIFO
+ * request queue. Every request runs the load function for one layer on one of
+ * the I/O threads, so no thread is created or destroyed per layer.
+ *
+ */
+class PrefetchEngine {
+public:
+  /**
+   * @brief Function that loads one layer. The flag is set when the request is
+   * cancelled, the function should then stop as soon as possible.
+   *
+   */
+  using LoadFunc = std::function<void(int, const std::atomic<bool> &)>;
+
+  /**
+   * @brief Construct a new Prefetch Engine object
+   *
+   * @param num_io_threads number of I/O threads to run loads on
+   * @param load function that loads one layer
+   */
+  PrefetchEngine(std::size_t num_io_threads, LoadFunc load);
+
+  /**
+   * @brief Destroy the Prefetch Engine object. Finishes queued requests first.
+   *
+   */
+  ~PrefetchEngine();
+
+  PrefetchEngine(const PrefetchEngine &) = delete;
+  PrefetchEngine &operator=(const PrefetchEngine &) = delete;
+
+  /**
+   * @brief Queue a load of the given layer
+   *
+   * @param layer_id layer to load
+   * @return PrefetchHandle handle to wait on the load
+   */
+  PrefetchHandle prefetch(int layer_id);
+
+  /**
+   * @brief Block until every queued and running request has finished
+   *
+   */
+  void drain();
+
+  /**
+   * @brief Get the number of queued and running requests
+   *
+   * @return std::size_t number of unfinished requests
+   */
+  std::size_t getPending() const;
+
+private:
+  /**
+   * @brief I/O thread body
+   *
+   */
+  void worker();
+
+  LoadFunc load;
+  std::vector<std::thread> io_threads;
+  std::deque<std::shared_ptr<PrefetchHandle::Request>> queue;
+  std::size_t running = 0;
+  bool stop = false;
+  mutable std::mutex queue_mutex;
+  std::condition_variable request_available_cv;
+  std::condition_variable requests_done_cv;
+};
+} // namespace nntrainer
+
+#endif // PREFETCH_ENGINE_HPP
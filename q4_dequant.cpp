@@ -0,0 +1,579 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   q4_dequant.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  int4 weight unpacking and kernels for unpacked weights source file
+ */
+
+#include "q4_dequant.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define Q4_DEQUANT_X86 1
+#endif
+
+namespace nntrainer {
+
+namespace {
+constexpr std::size_t BLOCK = Q8Vector::BLOCK;
+constexpr std::size_t BLOCK_BYTES = BLOCK / 2;
+constexpr int Q4_OFFSET = 8;
+// unpacked tensors start on a cache line
+constexpr std::size_t TENSOR_ALIGN = 64;
+// weight bytes of a GEMM row block, reused by every activation vector
+constexpr std::size_t GEMM_BLOCK_BYTES = 256 * 1024;
+
+std::uint16_t fp32_to_fp16(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+  std::int32_t exponent = static_cast<std::int32_t>((bits >> 23) & 0xFF) - 112;
+  std::uint32_t mantissa = bits & 0x7FFFFF;
+
+  if (exponent >= 31) // overflow, infinity and NaN
+    return sign | (((bits & 0x7FFFFFFF) > 0x7F800000) ? 0x7E00 : 0x7C00);
+  if (exponent <= 0) {
+    if (exponent < -10)
+      return sign;
+    // subnormal, the implicit bit becomes part of the mantissa
+    mantissa |= 0x800000;
+    std::uint32_t shift = static_cast<std::uint32_t>(14 - exponent);
+    std::uint32_t half = mantissa >> shift;
+    std::uint32_t rest = mantissa & ((1u << shift) - 1);
+    std::uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half & 1)))
+      ++half;
+    return sign | static_cast<std::uint16_t>(half);
+  }
+  std::uint32_t half = (static_cast<std::uint32_t>(exponent) << 10) |
+                       (mantissa >> 13);
+  std::uint32_t rest = mantissa & 0x1FFF;
+  // a carry out of the mantissa correctly bumps the exponent
+  if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+    ++half;
+  return sign | static_cast<std::uint16_t>(half);
+}
+
+float fp16_to_fp32(std::uint16_t half) {
+  std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000) << 16;
+  std::uint32_t exponent = (half >> 10) & 0x1F;
+  std::uint32_t mantissa = half & 0x3FF;
+  std::uint32_t bits;
+  if (exponent == 0x1F) {
+    bits = sign | 0x7F800000 | (mantissa << 13);
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  } else if (mantissa == 0) {
+    bits = sign;
+  } else {
+    // subnormal, normalise it
+    exponent = 113;
+    while (!(mantissa & 0x400)) {
+      mantissa <<= 1;
+      --exponent;
+    }
+    bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+  }
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+std::uint16_t fp32_to_bf16(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  // round to nearest even, weights are never NaN
+  bits += 0x7FFF + ((bits >> 16) & 1);
+  return static_cast<std::uint16_t>(bits >> 16);
+}
+
+float bf16_to_fp32(std::uint16_t bf16) {
+  std::uint32_t bits = static_cast<std::uint32_t>(bf16) << 16;
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// unpacks whole Q8Vector blocks of a row into I8
+using UnpackI8Func = void (*)(const std::uint8_t *, std::int8_t *,
+                              std::size_t);
+// unpacks bytes into F16 or BF16 values in natural column order
+using UnpackF16Func = void (*)(const std::uint8_t *, std::uint16_t *,
+                               std::size_t, float);
+using DotI8Func = std::int32_t (*)(const std::int8_t *, const std::int8_t *,
+                                   std::size_t);
+using DotF16Func = float (*)(const std::uint16_t *, const float *,
+                             std::size_t);
+
+void unpack_i8_scalar(const std::uint8_t *src, std::int8_t *dst,
+                      std::size_t blocks) {
+  for (std::size_t b = 0; b < blocks; ++b)
+    for (std::size_t i = 0; i < BLOCK_BYTES; ++i) {
+      std::uint8_t byte = src[b * BLOCK_BYTES + i];
+      dst[b * BLOCK + i] = static_cast<std::int8_t>((byte & 0x0F) - Q4_OFFSET);
+      dst[b * BLOCK + BLOCK_BYTES + i] =
+        static_cast<std::int8_t>((byte >> 4) - Q4_OFFSET);
+    }
+}
+
+template <bool BF16>
+void unpack_f16_scalar(const std::uint8_t *src, std::uint16_t *dst,
+                       std::size_t bytes, float scale) {
+  for (std::size_t i = 0; i < bytes; ++i) {
+    float lo = static_cast<float>((src[i] & 0x0F) - Q4_OFFSET) * scale;
+    float hi = static_cast<float>((src[i] >> 4) - Q4_OFFSET) * scale;
+    dst[2 * i] = BF16 ? fp32_to_bf16(lo) : fp32_to_fp16(lo);
+    dst[2 * i + 1] = BF16 ? fp32_to_bf16(hi) : fp32_to_fp16(hi);
+  }
+}
+
+std::int32_t dot_i8_scalar(const std::int8_t *w, const std::int8_t *x,
+                           std::size_t n) {
+  std::int32_t dot = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    dot += w[i] * x[i];
+  return dot;
+}
+
+template <bool BF16>
+float dot_f16_scalar(const std::uint16_t *w, const float *x, std::size_t n) {
+  float dot = 0.0f;
+  for (std::size_t i = 0; i < n; ++i)
+    dot += (BF16 ? bf16_to_fp32(w[i]) : fp16_to_fp32(w[i])) * x[i];
+  return dot;
+}
+
+#ifdef Q4_DEQUANT_X86
+__attribute__((target("avx2"))) void
+unpack_i8_avx2(const std::uint8_t *src, std::int8_t *dst, std::size_t blocks) {
+  const __m256i mask = _mm256_set1_epi8(0x0F);
+  const __m256i offset = _mm256_set1_epi8(Q4_OFFSET);
+  for (std::size_t b = 0; b < blocks; ++b) {
+    __m256i q = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i *>(src + b * BLOCK_BYTES));
+    __m256i lo = _mm256_sub_epi8(_mm256_and_si256(q, mask), offset);
+    __m256i hi = _mm256_sub_epi8(
+      _mm256_and_si256(_mm256_srli_epi16(q, 4), mask), offset);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + b * BLOCK), lo);
+    _mm256_storeu_si256(
+      reinterpret_cast<__m256i *>(dst + b * BLOCK + BLOCK_BYTES), hi);
+  }
+}
+
+// 8 int4 values, already interleaved into natural order, to F16 or BF16
+template <bool BF16>
+__attribute__((target("avx2,fma,f16c"))) inline __m128i
+convert8_avx2(__m128i q, __m256 scale) {
+  __m256i values = _mm256_sub_epi32(_mm256_cvtepu8_epi32(q),
+                                    _mm256_set1_epi32(Q4_OFFSET));
+  __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(values), scale);
+  if (!BF16)
+    return _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256i bits = _mm256_castps_si256(f);
+  bits = _mm256_add_epi32(
+    bits, _mm256_add_epi32(_mm256_set1_epi32(0x7FFF),
+                           _mm256_and_si256(_mm256_srli_epi32(bits, 16),
+                                            _mm256_set1_epi32(1))));
+  bits = _mm256_srli_epi32(bits, 16);
+  return _mm_packus_epi32(_mm256_castsi256_si128(bits),
+                          _mm256_extracti128_si256(bits, 1));
+}
+
+template <bool BF16>
+__attribute__((target("avx2,fma,f16c"))) void
+unpack_f16_avx2(const std::uint8_t *src, std::uint16_t *dst, std::size_t bytes,
+                float scale) {
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  const __m256 scale8 = _mm256_set1_ps(scale);
+  std::size_t i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    __m128i lo = _mm_and_si128(q, mask);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(q, 4), mask);
+    // even columns come from the low nibbles
+    __m128i first = _mm_unpacklo_epi8(lo, hi);
+    __m128i second = _mm_unpackhi_epi8(lo, hi);
+    __m128i *out = reinterpret_cast<__m128i *>(dst + 2 * i);
+    _mm_storeu_si128(out, convert8_avx2<BF16>(first, scale8));
+    _mm_storeu_si128(out + 1,
+                     convert8_avx2<BF16>(_mm_srli_si128(first, 8), scale8));
+    _mm_storeu_si128(out + 2, convert8_avx2<BF16>(second, scale8));
+    _mm_storeu_si128(out + 3,
+                     convert8_avx2<BF16>(_mm_srli_si128(second, 8), scale8));
+  }
+  unpack_f16_scalar<BF16>(src + i, dst + 2 * i, bytes - i, scale);
+}
+
+__attribute__((target("avx2"))) std::int32_t
+dot_i8_avx2(const std::int8_t *w, const std::int8_t *x, std::size_t n) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i acc = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + i));
+    __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+    // |w| <= 8, so a pair of products fits an int16 lane
+    __m256i products =
+      _mm256_maddubs_epi16(_mm256_abs_epi8(wv), _mm256_sign_epi8(xv, wv));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(products, ones));
+  }
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum) + dot_i8_scalar(w + i, x + i, n - i);
+}
+
+template <bool BF16>
+__attribute__((target("avx2,fma,f16c"))) float
+dot_f16_avx2(const std::uint16_t *w, const float *x, std::size_t n) {
+  __m256 acc = _mm256_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i wv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i));
+    __m256 wf =
+      BF16 ? _mm256_castsi256_ps(
+               _mm256_slli_epi32(_mm256_cvtepu16_epi32(wv), 16))
+           : _mm256_cvtph_ps(wv);
+    acc = _mm256_fmadd_ps(wf, _mm256_loadu_ps(x + i), acc);
+  }
+  __m128 sum =
+    _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum) + dot_f16_scalar<BF16>(w + i, x + i, n - i);
+}
+
+// the GCC 12 AVX-512 headers self-initialise the undefined vector passed to
+// masked builtins, which -Wuninitialized reports at every use
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f,avx512bw"))) void
+unpack_i8_avx512(const std::uint8_t *src, std::int8_t *dst,
+                 std::size_t blocks) {
+  const __m512i mask = _mm512_set1_epi8(0x0F);
+  const __m512i offset = _mm512_set1_epi8(Q4_OFFSET);
+  // two blocks per iteration, regrouped into low then high nibbles per block
+  std::size_t b = 0;
+  for (; b + 2 <= blocks; b += 2) {
+    __m512i q = _mm512_loadu_si512(src + b * BLOCK_BYTES);
+    __m512i lo = _mm512_sub_epi8(_mm512_and_si512(q, mask), offset);
+    __m512i hi = _mm512_sub_epi8(
+      _mm512_and_si512(_mm512_srli_epi16(q, 4), mask), offset);
+    _mm512_storeu_si512(dst + b * BLOCK,
+                        _mm512_shuffle_i64x2(lo, hi, _MM_SHUFFLE(1, 0, 1, 0)));
+    _mm512_storeu_si512(dst + (b + 1) * BLOCK,
+                        _mm512_shuffle_i64x2(lo, hi, _MM_SHUFFLE(3, 2, 3, 2)));
+  }
+  unpack_i8_scalar(src + b * BLOCK_BYTES, dst + b * BLOCK, blocks - b);
+}
+
+// 16 int4 values, already interleaved into natural order, to F16 or BF16
+template <bool BF16>
+__attribute__((target("avx512f,avx512bw"))) inline __m256i
+convert16_avx512(__m128i q, __m512 scale) {
+  __m512i values = _mm512_sub_epi32(_mm512_cvtepu8_epi32(q),
+                                    _mm512_set1_epi32(Q4_OFFSET));
+  __m512 f = _mm512_mul_ps(_mm512_cvtepi32_ps(values), scale);
+  if (!BF16)
+    return _mm512_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512i bits = _mm512_castps_si512(f);
+  bits = _mm512_add_epi32(
+    bits, _mm512_add_epi32(_mm512_set1_epi32(0x7FFF),
+                           _mm512_and_si512(_mm512_srli_epi32(bits, 16),
+                                            _mm512_set1_epi32(1))));
+  return _mm512_cvtepi32_epi16(_mm512_srli_epi32(bits, 16));
+}
+
+template <bool BF16>
+__attribute__((target("avx512f,avx512bw"))) void
+unpack_f16_avx512(const std::uint8_t *src, std::uint16_t *dst,
+                  std::size_t bytes, float scale) {
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  const __m512 scale16 = _mm512_set1_ps(scale);
+  std::size_t i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    __m128i lo = _mm_and_si128(q, mask);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(q, 4), mask);
+    __m256i *out = reinterpret_cast<__m256i *>(dst + 2 * i);
+    _mm256_storeu_si256(out,
+                        convert16_avx512<BF16>(_mm_unpacklo_epi8(lo, hi),
+                                               scale16));
+    _mm256_storeu_si256(out + 1,
+                        convert16_avx512<BF16>(_mm_unpackhi_epi8(lo, hi),
+                                               scale16));
+  }
+  unpack_f16_scalar<BF16>(src + i, dst + 2 * i, bytes - i, scale);
+}
+
+__attribute__((target("avx512f,avx512bw"))) std::int32_t
+dot_i8_avx512(const std::int8_t *w, const std::int8_t *x, std::size_t n) {
+  const __m512i ones = _mm512_set1_epi16(1);
+  const __m512i zero = _mm512_setzero_si512();
+  __m512i acc = _mm512_setzero_si512();
+  std::size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    __m512i wv = _mm512_loadu_si512(w + i);
+    __m512i xv = _mm512_loadu_si512(x + i);
+    // AVX-512 has no sign_epi8, negate x where w is negative instead
+    __m512i signed_x =
+      _mm512_mask_sub_epi8(xv, _mm512_movepi8_mask(wv), zero, xv);
+    __m512i products = _mm512_maddubs_epi16(_mm512_abs_epi8(wv), signed_x);
+    acc = _mm512_add_epi32(acc, _mm512_madd_epi16(products, ones));
+  }
+  alignas(64) std::int32_t lanes[16];
+  _mm512_store_si512(lanes, acc);
+  std::int32_t dot = 0;
+  for (std::int32_t lane : lanes)
+    dot += lane;
+  return dot + dot_i8_scalar(w + i, x + i, n - i);
+}
+
+template <bool BF16>
+__attribute__((target("avx512f,avx512bw"))) float
+dot_f16_avx512(const std::uint16_t *w, const float *x, std::size_t n) {
+  __m512 acc = _mm512_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + i));
+    __m512 wf =
+      BF16 ? _mm512_castsi512_ps(
+               _mm512_slli_epi32(_mm512_cvtepu16_epi32(wv), 16))
+           : _mm512_cvtph_ps(wv);
+    acc = _mm512_fmadd_ps(wf, _mm512_loadu_ps(x + i), acc);
+  }
+  alignas(64) float lanes[16];
+  _mm512_store_ps(lanes, acc);
+  float dot = 0.0f;
+  for (float lane : lanes)
+    dot += lane;
+  return dot + dot_f16_scalar<BF16>(w + i, x + i, n - i);
+}
+#pragma GCC diagnostic pop
+#endif
+
+UnpackI8Func select_unpack_i8(GemvIsa isa) {
+#ifdef Q4_DEQUANT_X86
+  if (isa == GemvIsa::AVX512)
+    return unpack_i8_avx512;
+  if (isa == GemvIsa::AVX2)
+    return unpack_i8_avx2;
+#else
+  (void)isa;
+#endif
+  return unpack_i8_scalar;
+}
+
+template <bool BF16> UnpackF16Func select_unpack_f16(GemvIsa isa) {
+#ifdef Q4_DEQUANT_X86
+  if (isa == GemvIsa::AVX512)
+    return unpack_f16_avx512<BF16>;
+  if (isa == GemvIsa::AVX2)
+    return unpack_f16_avx2<BF16>;
+#else
+  (void)isa;
+#endif
+  return unpack_f16_scalar<BF16>;
+}
+
+DotI8Func select_dot_i8(GemvIsa isa) {
+#ifdef Q4_DEQUANT_X86
+  if (isa == GemvIsa::AVX512)
+    return dot_i8_avx512;
+  if (isa == GemvIsa::AVX2)
+    return dot_i8_avx2;
+#else
+  (void)isa;
+#endif
+  return dot_i8_scalar;
+}
+
+template <bool BF16> DotF16Func select_dot_f16(GemvIsa isa) {
+#ifdef Q4_DEQUANT_X86
+  if (isa == GemvIsa::AVX512)
+    return dot_f16_avx512<BF16>;
+  if (isa == GemvIsa::AVX2)
+    return dot_f16_avx2<BF16>;
+#else
+  (void)isa;
+#endif
+  return dot_f16_scalar<BF16>;
+}
+
+// bytes [begin, end) of one row, whole blocks go to the vector kernel
+void dequant_row_i8(const std::uint8_t *src, std::size_t cols,
+                    std::size_t begin, std::size_t end, std::int8_t *row,
+                    UnpackI8Func unpack) {
+  const std::size_t block_bytes_end = cols / BLOCK * BLOCK_BYTES;
+  std::size_t j = begin;
+  while (j < end) {
+    const std::size_t blocks_end = std::min(end, block_bytes_end);
+    if (j % BLOCK_BYTES == 0 && j + BLOCK_BYTES <= blocks_end) {
+      std::size_t blocks = (blocks_end - j) / BLOCK_BYTES;
+      unpack(src + (j - begin), row + 2 * j, blocks);
+      j += blocks * BLOCK_BYTES;
+      continue;
+    }
+    std::uint8_t byte = src[j - begin];
+    auto lo = static_cast<std::int8_t>((byte & 0x0F) - Q4_OFFSET);
+    auto hi = static_cast<std::int8_t>((byte >> 4) - Q4_OFFSET);
+    if (j < block_bytes_end) {
+      std::size_t in_block = j % BLOCK_BYTES;
+      row[2 * (j - in_block) + in_block] = lo;
+      row[2 * (j - in_block) + BLOCK_BYTES + in_block] = hi;
+    } else {
+      row[2 * j] = lo;
+      row[2 * j + 1] = hi;
+    }
+    ++j;
+  }
+}
+
+std::size_t align_up(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+bool canDequantQ4(DType dtype) {
+  return dtype == DType::I8 || dtype == DType::F16 || dtype == DType::BF16;
+}
+
+void dequantQ4(const std::uint8_t *src, std::size_t cols,
+               std::size_t byte_begin, std::size_t byte_end, float scale,
+               DType dtype, void *dst, GemvIsa isa) {
+  if (dtype == DType::F16 || dtype == DType::BF16) {
+    // natural column order, rows do not matter
+    UnpackF16Func unpack = dtype == DType::BF16 ? select_unpack_f16<true>(isa)
+                                                : select_unpack_f16<false>(isa);
+    unpack(src, static_cast<std::uint16_t *>(dst) + 2 * byte_begin,
+           byte_end - byte_begin, scale);
+    return;
+  }
+  if (dtype != DType::I8)
+    throw std::invalid_argument("Q4 can not be unpacked into this dtype");
+
+  const UnpackI8Func unpack = select_unpack_i8(isa);
+  const std::size_t row_bytes = cols / 2;
+  auto *out = static_cast<std::int8_t *>(dst);
+  for (std::size_t b = byte_begin; b < byte_end;) {
+    std::size_t row = b / row_bytes;
+    std::size_t end = std::min(byte_end, (row + 1) * row_bytes);
+    dequant_row_i8(src + (b - byte_begin), cols, b - row * row_bytes,
+                   end - row * row_bytes, out + row * cols, unpack);
+    b = end;
+  }
+}
+
+std::size_t gemmI8Parallel(const std::int8_t *weights, std::size_t rows,
+                           std::size_t cols, const std::vector<Q8Vector> &x,
+                           float scale, float *y, GemvIsa isa,
+                           BS::priority_t priority) {
+  const DotI8Func dot = select_dot_i8(isa);
+  const std::size_t block_rows =
+    std::max<std::size_t>(1, GEMM_BLOCK_BYTES / std::max<std::size_t>(cols, 1));
+  return splitRows(
+    x.size(), rows, cols,
+    [&](std::size_t begin, std::size_t end) {
+      for (std::size_t r0 = begin; r0 < end; r0 += block_rows) {
+        const std::size_t r1 = std::min(end, r0 + block_rows);
+        for (std::size_t m = 0; m < x.size(); ++m)
+          for (std::size_t r = r0; r < r1; ++r)
+            y[m * rows + r] =
+              scale * x[m].scale *
+              static_cast<float>(
+                dot(weights + r * cols, x[m].values.data(), cols));
+      }
+    },
+    priority);
+}
+
+std::size_t gemmF16Parallel(const std::uint16_t *weights, DType dtype,
+                            std::size_t rows, std::size_t cols, const float *x,
+                            std::size_t x_stride, std::size_t tokens, float *y,
+                            GemvIsa isa, BS::priority_t priority) {
+  const DotF16Func dot = dtype == DType::BF16 ? select_dot_f16<true>(isa)
+                                              : select_dot_f16<false>(isa);
+  const std::size_t block_rows = std::max<std::size_t>(
+    1, GEMM_BLOCK_BYTES / std::max<std::size_t>(cols * 2, 1));
+  return splitRows(
+    tokens, rows, cols,
+    [&](std::size_t begin, std::size_t end) {
+      for (std::size_t r0 = begin; r0 < end; r0 += block_rows) {
+        const std::size_t r1 = std::min(end, r0 + block_rows);
+        for (std::size_t m = 0; m < tokens; ++m)
+          for (std::size_t r = r0; r < r1; ++r)
+            y[m * rows + r] = dot(weights + r * cols, x + m * x_stride, cols);
+      }
+    },
+    priority);
+}
+
+DequantLayout::DequantLayout(const LayerInfo &layer, std::size_t length,
+                             DType dtype) {
+  if (!canDequantQ4(dtype))
+    throw std::invalid_argument(std::string("Q4 can not be unpacked into ") +
+                                dtypeName(dtype));
+  placements.resize(layer.tensors.size());
+  for (std::size_t i = 0; i < layer.tensors.size(); ++i) {
+    const TensorInfo &tensor = layer.tensors[i];
+    Placement &placement = placements[i];
+    placement.src_offset = tensor.offset;
+    placement.src_size = tensor.size;
+    placement.cols = tensor.cols;
+    placement.src_dtype = tensor.dtype;
+    placement.dst_dtype = tensor.dtype == DType::Q4 ? dtype : tensor.dtype;
+    if (tensor.offset + tensor.size > length)
+      continue;
+
+    placement.dst_offset = align_up(decoded_size, TENSOR_ALIGN);
+    std::size_t elements = static_cast<std::size_t>(tensor.rows) * tensor.cols;
+    decoded_size =
+      placement.dst_offset + (tensor.dtype == DType::Q4
+                                ? dtypeBytes(dtype, elements)
+                                : tensor.size);
+  }
+}
+
+std::size_t DequantLayout::offset(std::size_t tensor) const {
+  return placements.at(tensor).dst_offset;
+}
+
+DType DequantLayout::dtype(std::size_t tensor) const {
+  return placements.at(tensor).dst_dtype;
+}
+
+void DequantLayout::decode(std::size_t offset, const char *src,
+                           std::size_t size, char *dst, float scale,
+                           GemvIsa isa) const {
+  for (const Placement &placement : placements) {
+    if (placement.dst_offset == NOT_DECODED)
+      continue;
+    std::size_t begin = std::max(offset, placement.src_offset);
+    std::size_t end =
+      std::min(offset + size, placement.src_offset + placement.src_size);
+    if (begin >= end)
+      continue;
+
+    const char *from = src + (begin - offset);
+    std::size_t in_tensor = begin - placement.src_offset;
+    if (placement.src_dtype == DType::Q4)
+      dequantQ4(reinterpret_cast<const std::uint8_t *>(from), placement.cols,
+                in_tensor, end - placement.src_offset, scale,
+                placement.dst_dtype, dst + placement.dst_offset, isa);
+    else
+      std::memcpy(dst + placement.dst_offset + in_tensor, from, end - begin);
+  }
+}
+} // namespace nntrainer
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   q4_dequant.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  int4 weight unpacking and kernels for unpacked weights header file
+ *
+ * Q4 weights can be unpacked while they are loaded, so that compute finds them
+ * in the format its kernels read:
+ *  - I8: q - 8 without the scale, each row in the block order of Q8Vector
+ *  - F16 / BF16: (q - 8) * scale, row major in natural column order
+ */
+
+#ifndef Q4_DEQUANT_HPP
+#define Q4_DEQUANT_HPP
+
+#pragma once
+#include "q4_gemv.hpp"
+#include "weights_container.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nntrainer {
+
+/**
+ * @brief Check that Q4 weights can be unpacked into a data type
+ *
+ * @param dtype data type
+ * @return true for I8, F16 and BF16
+ */
+bool canDequantQ4(DType dtype);
+
+/**
+ * @brief Unpack bytes [byte_begin, byte_end) of a Q4 tensor
+ *
+ * @param src the packed bytes, src[0] is byte byte_begin of the tensor
+ * @param cols number of columns of the tensor, must be even
+ * @param byte_begin first byte of the tensor to unpack
+ * @param byte_end one past the last byte of the tensor to unpack
+ * @param scale weight scale of the tensor, unused for I8
+ * @param dtype data type to unpack into, see canDequantQ4()
+ * @param dst start of the unpacked tensor
+ * @param isa kernel to run, must be supported by the CPU
+ */
+void dequantQ4(const std::uint8_t *src, std::size_t cols,
+               std::size_t byte_begin, std::size_t byte_end, float scale,
+               DType dtype, void *dst, GemvIsa isa);
+
+/**
+ * @brief Y = X W^T for unpacked I8 weights, rows over the thread pool
+ *
+ * @param weights I8 weights, rows x cols in Q8Vector block order
+ * @param rows number of rows, the stride of y
+ * @param cols number of columns
+ * @param x M quantized activation vectors of cols values
+ * @param scale weight scale of the tensor
+ * @param y output, M x rows
+ * @param isa kernel to run, must be supported by the CPU
+ * @param priority priority of the pool tasks
+ * @return std::size_t number of threads the product was split over
+ */
+std::size_t gemmI8Parallel(const std::int8_t *weights, std::size_t rows,
+                           std::size_t cols, const std::vector<Q8Vector> &x,
+                           float scale, float *y, GemvIsa isa,
+                           BS::priority_t priority = BS::pr::highest);
+
+/**
+ * @brief Y = X W^T for unpacked F16 or BF16 weights, rows over the thread pool
+ *
+ * @param weights F16 or BF16 weights, rows x cols
+ * @param dtype DType::F16 or DType::BF16
+ * @param rows number of rows, the stride of y
+ * @param cols number of columns
+ * @param x M activation vectors of cols values
+ * @param x_stride distance between two activation vectors
+ * @param tokens M
+ * @param y output, M x rows
+ * @param isa kernel to run, must be supported by the CPU
+ * @param priority priority of the pool tasks
+ * @return std::size_t number of threads the product was split over
+ */
+std::size_t gemmF16Parallel(const std::uint16_t *weights, DType dtype,
+                            std::size_t rows, std::size_t cols, const float *x,
+                            std::size_t x_stride, std::size_t tokens, float *y,
+                            GemvIsa isa,
+                            BS::priority_t priority = BS::pr::highest);
+
+/**
+ * @brief DequantLayout places the tensors of a byte range of a layer once
+ * their Q4 weights are unpacked, and unpacks the range chunk by chunk as it
+ * arrives. Tensors of other types are copied as they are.
+ *
+ */
+class DequantLayout {
+public:
+  static constexpr std::size_t NOT_DECODED = static_cast<std::size_t>(-1);
+
+  DequantLayout() = default;
+
+  /**
+   * @brief Construct a new Dequant Layout object
+   *
+   * @param layer layer the range belongs to
+   * @param length bytes of the layer that are loaded, tensors past them are
+   * left out
+   * @param dtype data type Q4 tensors are unpacked into
+   * @throws std::invalid_argument if Q4 can not be unpacked into dtype
+   */
+  DequantLayout(const LayerInfo &layer, std::size_t length, DType dtype);
+
+  /**
+   * @brief Get the size of the unpacked range
+   *
+   * @return std::size_t size in bytes
+   */
+  std::size_t size() const { return decoded_size; }
+
+  /**
+   * @brief Get where a tensor starts once unpacked
+   *
+   * @param tensor index of the tensor in the layer
+   * @return std::size_t offset in the unpacked range, NOT_DECODED if the
+   * tensor is not part of the range
+   */
+  std::size_t offset(std::size_t tensor) const;
+
+  /**
+   * @brief Get the data type of a tensor once unpacked
+   *
+   * @param tensor index of the tensor in the layer
+   * @return DType data type
+   */
+  DType dtype(std::size_t tensor) const;
+
+  /**
+   * @brief Unpack a loaded chunk of the range. Chunks may be unpacked
+   * concurrently and in any order.
+   *
+   * @param offset offset of the chunk in the layer
+   * @param src the loaded bytes of the chunk
+   * @param size size of the chunk
+   * @param dst start of the unpacked range
+   * @param scale weight scale of the Q4 tensors
+   * @param isa kernel to run, must be supported by the CPU
+   */
+  void decode(std::size_t offset, const char *src, std::size_t size, char *dst,
+              float scale, GemvIsa isa) const;
+
+private:
+  /**
+   * @brief Placement of one tensor
+   *
+   */
+  struct Placement {
+    std::size_t src_offset = 0;
+    std::size_t src_size = 0;
+    std::size_t dst_offset = NOT_DECODED;
+    std::size_t cols = 0;
+    DType src_dtype = DType::Q4;
+    DType dst_dtype = DType::Q4;
+  };
+
+  std::vector<Placement> placements;
+  std::size_t decoded_size = 0;
+};
+} // namespace nntrainer
+
+#endif // Q4_DEQUANT_HPP
@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   q4_gemv.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  int4 weight x int8 activation GEMV/GEMM kernels source file
+ */
+
+#include "q4_gemv.hpp"
+#include "bs_thread_pool_manager.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define Q4_GEMV_X86 1
+#endif
+
+namespace nntrainer {
+
+namespace {
+constexpr std::size_t BLOCK = Q8Vector::BLOCK;
+constexpr std::size_t BLOCK_BYTES = BLOCK / 2;
+constexpr std::int32_t Q4_OFFSET = 8;
+// weight bytes of a GEMM row block, reused by every activation vector
+constexpr std::size_t GEMM_BLOCK_BYTES = 256 * 1024;
+
+using DotFunc = std::int32_t (*)(const std::uint8_t *, const std::int8_t *,
+                                 std::size_t);
+
+// dot product of one block of weights and activations
+std::int32_t dot_block_scalar(const std::uint8_t *w, const std::int8_t *x) {
+  std::int32_t dot = 0;
+  for (std::size_t i = 0; i < BLOCK_BYTES; ++i)
+    dot += (w[i] & 0x0F) * x[i] + (w[i] >> 4) * x[BLOCK_BYTES + i];
+  return dot;
+}
+
+std::int32_t dot_scalar(const std::uint8_t *w, const std::int8_t *x,
+                        std::size_t blocks) {
+  std::int32_t dot = 0;
+  for (std::size_t b = 0; b < blocks; ++b)
+    dot += dot_block_scalar(w + b * BLOCK_BYTES, x + b * BLOCK);
+  return dot;
+}
+
+#ifdef Q4_GEMV_X86
+__attribute__((target("avx2"))) std::int32_t
+dot_avx2(const std::uint8_t *w, const std::int8_t *x, std::size_t blocks) {
+  const __m256i mask = _mm256_set1_epi8(0x0F);
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i acc = _mm256_setzero_si256();
+
+  for (std::size_t b = 0; b < blocks; ++b) {
+    __m256i q = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i *>(w + b * BLOCK_BYTES));
+    __m256i lo = _mm256_and_si256(q, mask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(q, 4), mask);
+    __m256i even =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + b * BLOCK));
+    __m256i odd = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i *>(x + b * BLOCK + BLOCK_BYTES));
+    // at most 2 * 15 * 127 per int16 lane, no saturation
+    __m256i products = _mm256_add_epi16(_mm256_maddubs_epi16(lo, even),
+                                        _mm256_maddubs_epi16(hi, odd));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(products, ones));
+  }
+
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+// the GCC 12 AVX-512 headers self-initialise the undefined vector passed to
+// masked builtins, which -Wuninitialized reports at every use
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f,avx512bw"))) std::int32_t
+dot_avx512(const std::uint8_t *w, const std::int8_t *x, std::size_t blocks) {
+  const __m512i mask = _mm512_set1_epi8(0x0F);
+  const __m512i ones = _mm512_set1_epi16(1);
+  __m512i acc = _mm512_setzero_si512();
+
+  // two blocks per iteration, their even and odd halves are regrouped so
+  // that they line up with the low and high nibbles of 64 weight bytes
+  std::size_t b = 0;
+  for (; b + 2 <= blocks; b += 2) {
+    __m512i q = _mm512_loadu_si512(w + b * BLOCK_BYTES);
+    __m512i lo = _mm512_and_si512(q, mask);
+    __m512i hi = _mm512_and_si512(_mm512_srli_epi16(q, 4), mask);
+    __m512i x0 = _mm512_loadu_si512(x + b * BLOCK);
+    __m512i x1 = _mm512_loadu_si512(x + (b + 1) * BLOCK);
+    __m512i even = _mm512_shuffle_i64x2(x0, x1, _MM_SHUFFLE(1, 0, 1, 0));
+    __m512i odd = _mm512_shuffle_i64x2(x0, x1, _MM_SHUFFLE(3, 2, 3, 2));
+    __m512i products = _mm512_add_epi16(_mm512_maddubs_epi16(lo, even),
+                                        _mm512_maddubs_epi16(hi, odd));
+    acc = _mm512_add_epi32(acc, _mm512_madd_epi16(products, ones));
+  }
+
+  alignas(64) std::int32_t lanes[16];
+  _mm512_store_si512(lanes, acc);
+  std::int32_t dot = 0;
+  for (std::int32_t lane : lanes)
+    dot += lane;
+  if (b < blocks)
+    dot += dot_block_scalar(w + b * BLOCK_BYTES, x + b * BLOCK);
+  return dot;
+}
+#pragma GCC diagnostic pop
+#endif
+} // namespace
+
+namespace {
+DotFunc select_dot(GemvIsa isa) {
+#ifdef Q4_GEMV_X86
+  if (isa == GemvIsa::AVX512)
+    return dot_avx512;
+  if (isa == GemvIsa::AVX2)
+    return dot_avx2;
+#else
+  (void)isa;
+#endif
+  return dot_scalar;
+}
+
+float row_product(DotFunc dot, const std::uint8_t *row, std::size_t cols,
+                  const Q8Vector &x, float scale) {
+  const std::size_t blocks = cols / BLOCK;
+  const std::int8_t *xq = x.values.data();
+  std::int32_t acc = dot(row, xq, blocks);
+  for (std::size_t c = blocks * BLOCK; c < cols; c += 2) {
+    std::uint8_t byte = row[c / 2];
+    acc += (byte & 0x0F) * xq[c] + (byte >> 4) * xq[c + 1];
+  }
+  return scale * x.scale * static_cast<float>(acc - Q4_OFFSET * x.sum);
+}
+} // namespace
+
+GemvIsa detectGemvIsa() {
+#ifdef Q4_GEMV_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    return GemvIsa::AVX512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+      __builtin_cpu_supports("f16c"))
+    return GemvIsa::AVX2;
+#endif
+  return GemvIsa::SCALAR;
+}
+
+const char *gemvIsaName(GemvIsa isa) {
+  switch (isa) {
+  case GemvIsa::SCALAR:
+    return "scalar";
+  case GemvIsa::AVX2:
+    return "avx2";
+  case GemvIsa::AVX512:
+    return "avx512";
+  }
+  return "unknown";
+}
+
+void quantizeActivation(const float *x, std::size_t n, Q8Vector &out) {
+  float amax = 0.0f;
+  for (std::size_t i = 0; i < n; ++i)
+    amax = std::max(amax, std::fabs(x[i]));
+  out.scale = amax > 0.0f ? amax / 127.0f : 1.0f;
+  out.values.resize(n);
+  out.sum = 0;
+
+  const float inv_scale = 1.0f / out.scale;
+  const std::size_t full = n / BLOCK * BLOCK;
+  for (std::size_t i = 0; i < n; ++i) {
+    auto q = static_cast<std::int8_t>(std::lround(x[i] * inv_scale));
+    out.sum += q;
+    if (i >= full) {
+      out.values[i] = q;
+      continue;
+    }
+    std::size_t in_block = i % BLOCK;
+    std::size_t slot = in_block / 2 + (in_block % 2 ? BLOCK_BYTES : 0);
+    out.values[i - in_block + slot] = q;
+  }
+}
+
+void gemvQ4(const std::uint8_t *weights, std::size_t cols, const Q8Vector &x,
+            float scale, float *y, std::size_t row_begin, std::size_t row_end,
+            GemvIsa isa) {
+  const DotFunc dot = select_dot(isa);
+  const std::size_t row_bytes = cols / 2;
+  for (std::size_t r = row_begin; r < row_end; ++r)
+    y[r] = row_product(dot, weights + r * row_bytes, cols, x, scale);
+}
+
+void gemmQ4(const std::uint8_t *weights, std::size_t rows, std::size_t cols,
+            const std::vector<Q8Vector> &x, float scale, float *y,
+            std::size_t row_begin, std::size_t row_end, GemvIsa isa) {
+  const DotFunc dot = select_dot(isa);
+  const std::size_t row_bytes = cols / 2;
+  const std::size_t block_rows =
+    std::max<std::size_t>(1, GEMM_BLOCK_BYTES / std::max<std::size_t>(
+                                                  row_bytes, 1));
+
+  for (std::size_t r0 = row_begin; r0 < row_end; r0 += block_rows) {
+    const std::size_t r1 = std::min(row_end, r0 + block_rows);
+    for (std::size_t m = 0; m < x.size(); ++m)
+      for (std::size_t r = r0; r < r1; ++r)
+        y[m * rows + r] =
+          row_product(dot, weights + r * row_bytes, cols, x[m], scale);
+  }
+}
+
+std::size_t
+splitRows(std::size_t tokens, std::size_t rows, std::size_t cols,
+          const std::function<void(std::size_t, std::size_t)> &range,
+          BS::priority_t priority) {
+  std::size_t threads = ThreadPoolManager::select_k_quant_thread_count(
+    static_cast<unsigned int>(tokens), static_cast<unsigned int>(rows),
+    static_cast<unsigned int>(cols));
+  threads = std::min(threads, rows);
+  if (threads <= 1) {
+    range(0, rows);
+    return 1;
+  }
+
+  ThreadPoolManager::getInstance()
+    .submit_blocks(std::size_t{0}, rows, range, threads, priority)
+    .wait();
+  return threads;
+}
+
+std::size_t gemmQ4Parallel(const std::uint8_t *weights, std::size_t rows,
+                           std::size_t cols, const std::vector<Q8Vector> &x,
+                           float scale, float *y, GemvIsa isa,
+                           BS::priority_t priority) {
+  return splitRows(
+    x.size(), rows, cols,
+    [&](std::size_t begin, std::size_t end) {
+      gemmQ4(weights, rows, cols, x, scale, y, begin, end, isa);
+    },
+    priority);
+}
+} // namespace nntrainer
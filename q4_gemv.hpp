@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   q4_gemv.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  int4 weight x int8 activation GEMV/GEMM kernels header file
+ *
+ * Weights are DType::Q4 tensors as stored in the container: row major, two
+ * 4-bit values per byte, the even column in the low nibble. A value q stands
+ * for (q - 8) * scale with one scale per tensor. Activations are quantized to
+ * int8 with one scale per vector, so the kernels are integer dot products.
+ */
+
+#ifndef Q4_GEMV_HPP
+#define Q4_GEMV_HPP
+
+#pragma once
+#include "bs_thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace nntrainer {
+
+/**
+ * @brief Instruction set a GEMV kernel is written for
+ *
+ */
+enum class GemvIsa { SCALAR, AVX2, AVX512 };
+
+/**
+ * @brief Get the best instruction set the CPU supports. AVX2 includes FMA and
+ * F16C, which every AVX2 CPU has.
+ *
+ * @return GemvIsa instruction set
+ */
+GemvIsa detectGemvIsa();
+
+/**
+ * @brief Get a printable name of the instruction set
+ *
+ * @param isa instruction set
+ * @return const char* name
+ */
+const char *gemvIsaName(GemvIsa isa);
+
+/**
+ * @brief An activation vector quantized to int8. The values are stored in
+ * blocks of Q8_BLOCK columns, each block holding its even columns and then its
+ * odd columns, which is the order the nibbles of a weight row unpack in.
+ * Columns past the last full block follow in their natural order.
+ *
+ */
+struct Q8Vector {
+  static constexpr std::size_t BLOCK = 64;
+
+  std::vector<std::int8_t> values;
+  float scale = 0.0f; /**< value of one int8 step */
+  std::int32_t sum = 0; /**< sum of all values, removes the weight offset */
+};
+
+/**
+ * @brief Quantize an activation vector
+ *
+ * @param x activations
+ * @param n number of activations
+ * @param out quantized vector, resized to n
+ */
+void quantizeActivation(const float *x, std::size_t n, Q8Vector &out);
+
+/**
+ * @brief y = W x for an int4 weight matrix, rows [row_begin, row_end) only
+ *
+ * @param weights Q4 weights, rows x cols
+ * @param cols number of columns, must be even
+ * @param x quantized activations of cols values
+ * @param scale weight scale of the tensor
+ * @param y output, indexed by row
+ * @param row_begin first row to compute
+ * @param row_end one past the last row to compute
+ * @param isa kernel to run, must be supported by the CPU
+ */
+void gemvQ4(const std::uint8_t *weights, std::size_t cols, const Q8Vector &x,
+            float scale, float *y, std::size_t row_begin, std::size_t row_end,
+            GemvIsa isa);
+
+/**
+ * @brief Y = X W^T for an int4 weight matrix and M activation vectors, rows
+ * [row_begin, row_end) only. Rows are walked in blocks that stay in cache
+ * while every activation vector is multiplied with them.
+ *
+ * @param weights Q4 weights, rows x cols
+ * @param rows number of rows, the stride of y
+ * @param cols number of columns, must be even
+ * @param x M quantized activation vectors of cols values
+ * @param scale weight scale of the tensor
+ * @param y output, M x rows
+ * @param row_begin first row to compute
+ * @param row_end one past the last row to compute
+ * @param isa kernel to run, must be supported by the CPU
+ */
+void gemmQ4(const std::uint8_t *weights, std::size_t rows, std::size_t cols,
+            const std::vector<Q8Vector> &x, float scale, float *y,
+            std::size_t row_begin, std::size_t row_end, GemvIsa isa);
+
+/**
+ * @brief Run a product over row ranges on the shared thread pool.
+ * ThreadPoolManager::select_k_quant_thread_count() picks the number of ranges
+ * from the size of the product; a single range runs on the calling thread.
+ *
+ * @param tokens number of activation vectors
+ * @param rows number of rows
+ * @param cols number of columns
+ * @param range computes rows [begin, end)
+ * @param priority priority of the pool tasks
+ * @return std::size_t number of ranges the rows were split into
+ */
+std::size_t splitRows(
+  std::size_t tokens, std::size_t rows, std::size_t cols,
+  const std::function<void(std::size_t, std::size_t)> &range,
+  BS::priority_t priority = BS::pr::highest);
+
+/**
+ * @brief gemmQ4() over all rows, split into row ranges on the shared thread
+ * pool with splitRows().
+ *
+ * @param weights Q4 weights, rows x cols
+ * @param rows number of rows
+ * @param cols number of columns, must be even
+ * @param x M quantized activation vectors of cols values
+ * @param scale weight scale of the tensor
+ * @param y output, M x rows
+ * @param isa kernel to run, must be supported by the CPU
+ * @param priority priority of the pool tasks
+ * @return std::size_t number of threads the product was split over
+ */
+std::size_t gemmQ4Parallel(const std::uint8_t *weights, std::size_t rows,
+                           std::size_t cols, const std::vector<Q8Vector> &x,
+                           float scale, float *y, GemvIsa isa,
+                           BS::priority_t priority = BS::pr::highest);
+} // namespace nntrainer
+
+#endif // Q4_GEMV_HPP
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   request_batcher.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Batches queued inference requests source file
+ */
+
+#include "request_batcher.hpp"
+
+#include <stdexcept>
+
+namespace nntrainer {
+
+RequestBatcher::RequestBatcher(
+  std::size_t max_batch, std::chrono::duration<double, std::milli> timeout) :
+  max_batch(max_batch), timeout(timeout) {
+  if (max_batch == 0)
+    throw std::invalid_argument("batch size must be positive");
+}
+
+void RequestBatcher::submit(int id) {
+  {
+    std::scoped_lock lock(queue_mutex);
+    queue.push_back({id, std::chrono::steady_clock::now()});
+  }
+  queue_cv.notify_all();
+}
+
+void RequestBatcher::close() {
+  {
+    std::scoped_lock lock(queue_mutex);
+    closed = true;
+  }
+  queue_cv.notify_all();
+}
+
+std::vector<InferenceRequest> RequestBatcher::nextBatch() {
+  std::unique_lock lock(queue_mutex);
+  queue_cv.wait(lock, [this] { return !queue.empty() || closed; });
+  if (queue.empty())
+    return {};
+
+  // the timeout runs from the arrival of the oldest request, a request that
+  // already waited for the previous batch is not held back again
+  auto deadline =
+    queue.front().arrival +
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+  queue_cv.wait_until(lock, deadline,
+                      [this] { return queue.size() >= max_batch || closed; });
+
+  std::vector<InferenceRequest> batch;
+  while (!queue.empty() && batch.size() < max_batch) {
+    batch.push_back(queue.front());
+    queue.pop_front();
+  }
+  ++batches;
+  return batch;
+}
+
+std::size_t RequestBatcher::getBatches() const {
+  std::scoped_lock lock(queue_mutex);
+  return batches;
+}
+} // namespace nntrainer
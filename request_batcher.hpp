@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   request_batcher.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Batches queued inference requests header file
+ */
+
+#ifndef REQUEST_BATCHER_HPP
+#define REQUEST_BATCHER_HPP
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace nntrainer {
+
+/**
+ * @brief A queued inference request
+ *
+ */
+struct InferenceRequest {
+  int id;                                        /**< request id */
+  std::chrono::steady_clock::time_point arrival; /**< time it was submitted */
+};
+
+/**
+ * @brief RequestBatcher collects queued inference requests into batches that
+ * share every layer load. A batch is handed out as soon as it is full, or
+ * once its oldest request has waited for the batching timeout.
+ *
+ */
+class RequestBatcher {
+public:
+  /**
+   * @brief Construct a new Request Batcher object
+   *
+   * @param max_batch largest number of requests in a batch
+   * @param timeout longest time a request waits for others to join its batch
+   * @throws std::invalid_argument if max_batch is 0
+   */
+  RequestBatcher(std::size_t max_batch,
+                 std::chrono::duration<double, std::milli> timeout);
+
+  /**
+   * @brief Queue a request. Thread safe.
+   *
+   * @param id request id
+   */
+  void submit(int id);
+
+  /**
+   * @brief Mark that no more requests will be submitted. Thread safe.
+   *
+   */
+  void close();
+
+  /**
+   * @brief Wait for the next batch
+   *
+   * @return std::vector<InferenceRequest> requests of the batch in arrival
+   * order, empty once the batcher is closed and drained
+   */
+  std::vector<InferenceRequest> nextBatch();
+
+  /**
+   * @brief Get the number of batches handed out
+   *
+   * @return std::size_t number of batches
+   */
+  std::size_t getBatches() const;
+
+private:
+  std::size_t max_batch;
+  std::chrono::duration<double, std::milli> timeout;
+  std::deque<InferenceRequest> queue;
+  bool closed = false;
+  std::size_t batches = 0;
+  mutable std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+};
+} // namespace nntrainer
+
+#endif // REQUEST_BATCHER_HPP
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   residency_planner.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Latency target driven resident layer planner source file
+ */
+
+#include "residency_planner.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace nntrainer {
+
+ResidencyPlanner::ResidencyPlanner(std::size_t look_ahead, bool continuous) :
+  look_ahead(look_ahead), continuous(continuous) {
+  if (look_ahead == 0)
+    throw std::invalid_argument("look-ahead must be positive");
+}
+
+double ResidencyPlanner::predict(const std::vector<double> &load_ms,
+                                 double compute_ms,
+                                 const std::vector<bool> &resident) const {
+  const std::size_t layers = load_ms.size();
+  const std::size_t passes = continuous ? CONTINUOUS_PASSES : 1;
+  std::vector<double> compute_end(layers * passes, 0.0);
+  double storage_free = 0.0;
+  double previous_end = 0.0;
+  double pass_start = 0.0;
+
+  for (std::size_t step = 0; step < compute_end.size(); ++step) {
+    const std::size_t i = step % layers;
+    if (i == 0)
+      pass_start = previous_end;
+    double ready = 0.0;
+    if (!resident[i]) {
+      double issued =
+        step < look_ahead ? 0.0 : compute_end[step - look_ahead];
+      ready = std::max(issued, storage_free) + load_ms[i];
+      storage_free = ready;
+    }
+    compute_end[step] = std::max(previous_end, ready) + compute_ms;
+    previous_end = compute_end[step];
+  }
+  return previous_end - pass_start;
+}
+
+ResidencyPlan ResidencyPlanner::plan(
+  const std::vector<double> &load_ms,
+  const std::vector<std::size_t> &layer_bytes, double compute_ms,
+  double target_ms, std::size_t budget_bytes) const {
+  if (load_ms.size() != layer_bytes.size())
+    throw std::invalid_argument("load times and layer sizes do not match");
+
+  ResidencyPlan plan;
+  plan.resident.assign(load_ms.size(), false);
+  plan.resident_bytes = 0;
+  plan.predicted_token_ms = predict(load_ms, compute_ms, plan.resident);
+
+  while (plan.predicted_token_ms > target_ms) {
+    int best = -1;
+    double best_ms = plan.predicted_token_ms;
+    double best_gain = -1.0;
+
+    for (std::size_t i = 0; i < load_ms.size(); ++i) {
+      if (plan.resident[i] ||
+          plan.resident_bytes + layer_bytes[i] > budget_bytes)
+        continue;
+      plan.resident[i] = true;
+      double ms = predict(load_ms, compute_ms, plan.resident);
+      plan.resident[i] = false;
+
+      // gain per byte; the earliest layer wins ties, it shortens the ramp up
+      double bytes = std::max(static_cast<double>(layer_bytes[i]), 1.0);
+      double gain = (plan.predicted_token_ms - ms) / bytes;
+      if (gain > best_gain) {
+        best = static_cast<int>(i);
+        best_ms = ms;
+        best_gain = gain;
+      }
+    }
+    if (best < 0)
+      break;
+
+    plan.resident[best] = true;
+    plan.resident_bytes += layer_bytes[best];
+    plan.predicted_token_ms = best_ms;
+  }
+
+  plan.meets_target = plan.predicted_token_ms <= target_ms;
+  return plan;
+}
+} // namespace nntrainer
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   residency_planner.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Latency target driven resident layer planner header file
+ */
+
+#ifndef RESIDENCY_PLANNER_HPP
+#define RESIDENCY_PLANNER_HPP
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace nntrainer {
+
+/**
+ * @brief Which layers stay resident and what a token is expected to cost
+ *
+ */
+struct ResidencyPlan {
+  std::vector<bool> resident;   /**< per layer, true if kept in memory */
+  std::size_t resident_bytes;   /**< memory held by resident layers */
+  double predicted_token_ms;    /**< predicted latency of one forward pass */
+  bool meets_target;            /**< predicted latency is within the target */
+};
+
+/**
+ * @brief ResidencyPlanner chooses the layers to keep resident so that a
+ * forward pass meets a latency target within a memory budget. It simulates
+ * the pipeline: streamed layers are read one after another by the storage,
+ * a load is issued once the layer look_ahead places earlier has been
+ * computed, and compute of a layer starts when the previous layer is done and
+ * its weights are ready. In continuous decode the simulated passes run back
+ * to back and the last one is reported. Layers are made resident greedily,
+ * each time the one that shortens the predicted pass the most per byte, until
+ * the target is met or the budget is used up.
+ *
+ */
+class ResidencyPlanner {
+public:
+  /**
+   * @brief Construct a new Residency Planner object
+   *
+   * @param look_ahead number of layers prefetched ahead of compute
+   * @param continuous true if the next forward pass is prefetched while the
+   * current one computes, the prediction then is the steady state pass time
+   */
+  explicit ResidencyPlanner(std::size_t look_ahead, bool continuous = false);
+
+  /**
+   * @brief Plan the resident layers
+   *
+   * @param load_ms storage time to read each layer when streamed
+   * @param layer_bytes memory a resident layer holds
+   * @param compute_ms compute time of a layer
+   * @param target_ms latency target of one forward pass
+   * @param budget_bytes memory available for resident layers
+   * @return ResidencyPlan the plan, with meets_target false if the target can
+   * not be met within the budget (the plan then is the fastest one found)
+   */
+  ResidencyPlan plan(const std::vector<double> &load_ms,
+                     const std::vector<std::size_t> &layer_bytes,
+                     double compute_ms, double target_ms,
+                     std::size_t budget_bytes) const;
+
+  /**
+   * @brief Predict the latency of one forward pass
+   *
+   * @param load_ms storage time to read each layer when streamed
+   * @param compute_ms compute time of a layer
+   * @param resident per layer, true if the layer needs no load
+   * @return double predicted latency in milliseconds
+   */
+  double predict(const std::vector<double> &load_ms, double compute_ms,
+                 const std::vector<bool> &resident) const;
+
+private:
+  static constexpr std::size_t CONTINUOUS_PASSES = 3;
+
+  std::size_t look_ahead;
+  bool continuous;
+};
+} // namespace nntrainer
+
+#endif // RESIDENCY_PLANNER_HPP
@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   staged_pipeline.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Multi-stage layer pipeline with bounded queues source file
+ */
+
+#include "staged_pipeline.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace nntrainer {
+
+namespace {
+// blocked time the stage function running on this thread has reported
+thread_local double blocked_ms = 0.0;
+} // namespace
+
+void StagedPipeline::addBlocked(double ms) { blocked_ms += ms; }
+
+void StagedPipeline::Occupancy::add(long delta, Clock::time_point now) {
+  area += static_cast<double>(size) *
+          std::chrono::duration<double, std::milli>(now - last_change).count();
+  last_change = now;
+  size = static_cast<std::size_t>(static_cast<long>(size) + delta);
+  max = std::max(max, size);
+}
+
+StagedPipeline::StagedPipeline(std::vector<Stage> stage_list,
+                               std::string consumer) :
+  consumer_name(std::move(consumer)), created(Clock::now()) {
+  if (stage_list.empty())
+    throw std::invalid_argument("staged pipeline needs at least one stage");
+  consumer_queue.last_change = created;
+
+  for (auto &stage : stage_list) {
+    if (stage.threads == 0)
+      throw std::invalid_argument("stage " + stage.name + " has no threads");
+    auto state = std::make_unique<StageState>();
+    state->stage = std::move(stage);
+    state->occupancy.last_change = created;
+    stages.push_back(std::move(state));
+  }
+  stages.front()->stage.capacity = 0;
+
+  for (std::size_t i = 0; i < stages.size(); ++i)
+    for (std::size_t t = 0; t < stages[i]->stage.threads; ++t)
+      stages[i]->workers.emplace_back(&StagedPipeline::worker, this, i);
+}
+
+StagedPipeline::~StagedPipeline() {
+  // stage by stage, so that every stage sees all items of the one before it
+  for (auto &state : stages) {
+    {
+      std::scoped_lock lock(pipeline_mutex);
+      state->stop = true;
+    }
+    state->not_empty.notify_all();
+    for (auto &thread : state->workers)
+      thread.join();
+  }
+}
+
+PrefetchHandle StagedPipeline::submit(int item) {
+  auto request = std::make_shared<Request>();
+  request->layer_id = item;
+  request->done_future = request->done.get_future().share();
+  StageState &first = *stages.front();
+  {
+    std::scoped_lock lock(pipeline_mutex);
+    first.queue.push_back(request);
+    first.occupancy.add(1, Clock::now());
+    ++pending;
+  }
+  first.not_empty.notify_one();
+  return PrefetchHandle(std::move(request));
+}
+
+void StagedPipeline::beginConsume(const PrefetchHandle &handle) {
+  if (!handle)
+    return;
+  std::scoped_lock lock(pipeline_mutex);
+  handle.request->consumed = true;
+  consuming_stage = handle.request->stage;
+  auto it = std::find(ready.begin(), ready.end(), handle.request);
+  if (it != ready.end()) {
+    ready.erase(it);
+    consumer_queue.add(-1, Clock::now());
+  }
+}
+
+void StagedPipeline::endConsume(double busy_ms, double waited_ms) {
+  std::scoped_lock lock(pipeline_mutex);
+  ++consumer_items;
+  consumer_busy_ms += busy_ms;
+  if (consuming_stage < stages.size())
+    stages[consuming_stage]->holding_ms += waited_ms;
+}
+
+void StagedPipeline::drain() {
+  std::unique_lock lock(pipeline_mutex);
+  pending_cv.wait(lock, [this] { return pending == 0; });
+}
+
+std::size_t StagedPipeline::getPending() const {
+  std::scoped_lock lock(pipeline_mutex);
+  return pending;
+}
+
+std::vector<StagedPipeline::StageStats> StagedPipeline::getStats() const {
+  std::scoped_lock lock(pipeline_mutex);
+  Clock::time_point now = Clock::now();
+  double elapsed_ms =
+    std::max(std::chrono::duration<double, std::milli>(now - created).count(),
+             1e-9);
+
+  auto queue_stats = [&](StageStats &stats, Occupancy occupancy) {
+    occupancy.add(0, now);
+    stats.mean_queue = occupancy.area / elapsed_ms;
+    stats.max_queue = occupancy.max;
+  };
+
+  std::vector<StageStats> result;
+  for (const auto &state : stages) {
+    StageStats stats;
+    stats.name = state->stage.name;
+    stats.threads = state->stage.threads;
+    stats.items = state->items;
+    stats.busy_ms = state->busy_ms;
+    stats.utilization = state->busy_ms / (stats.threads * elapsed_ms);
+    stats.holding_ms = state->holding_ms;
+    stats.capacity = state->stage.capacity;
+    queue_stats(stats, state->occupancy);
+    result.push_back(stats);
+  }
+
+  // one consumer, its queue holds what the slots of the stages allow
+  StageStats consumer;
+  consumer.name = consumer_name;
+  consumer.threads = 1;
+  consumer.items = consumer_items;
+  consumer.busy_ms = consumer_busy_ms;
+  consumer.utilization = consumer_busy_ms / elapsed_ms;
+  consumer.holding_ms = consumer_holding_ms;
+  queue_stats(consumer, consumer_queue);
+  result.push_back(consumer);
+  return result;
+}
+
+void StagedPipeline::finish(const std::shared_ptr<Request> &request,
+                            std::exception_ptr error) {
+  if (error)
+    request->done.set_exception(error);
+  else
+    request->done.set_value();
+  request->stage = stages.size();
+  // cancelled items are never consumed
+  if (!error && !request->consumed &&
+      !request->cancelled.load(std::memory_order_acquire)) {
+    ready.push_back(request);
+    consumer_queue.add(1, Clock::now());
+  }
+  if (--pending == 0)
+    pending_cv.notify_all();
+}
+
+void StagedPipeline::worker(std::size_t index) {
+  StageState &state = *stages[index];
+  StageState *prev = index > 0 ? stages[index - 1].get() : nullptr;
+  StageState *next = index + 1 < stages.size() ? stages[index + 1].get()
+                                               : nullptr;
+  auto ms = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+  while (true) {
+    std::shared_ptr<Request> request;
+    {
+      std::unique_lock lock(pipeline_mutex);
+      auto wait_start = Clock::now();
+      state.not_empty.wait(
+        lock, [&state] { return state.stop || !state.queue.empty(); });
+      if (state.queue.empty())
+        break;
+      request = std::move(state.queue.front());
+      state.queue.pop_front();
+      auto now = Clock::now();
+      state.occupancy.add(-1, now);
+      // idle while the stage before was still on the item
+      if (prev)
+        prev->holding_ms += std::max(
+          0.0, ms(now - std::max(wait_start, request->stage_start)));
+      request->stage_start = now;
+    }
+    state.not_full.notify_one();
+
+    std::exception_ptr error;
+    blocked_ms = 0.0;
+    auto start = Clock::now();
+    try {
+      state.stage.func(request->layer_id, request->cancelled);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    auto end = Clock::now();
+
+    {
+      std::unique_lock lock(pipeline_mutex);
+      ++state.items;
+      state.busy_ms += ms(end - start) - blocked_ms;
+      consumer_holding_ms += blocked_ms;
+      if (!next || error) {
+        finish(request, error);
+        continue;
+      }
+      // a full queue holds this item, and the thread, back
+      std::size_t capacity = next->stage.capacity;
+      auto wait_start = Clock::now();
+      next->not_full.wait(lock, [next, capacity] {
+        return capacity == 0 || next->queue.size() < capacity;
+      });
+      auto now = Clock::now();
+      next->holding_ms += ms(now - wait_start);
+      request->stage = index + 1;
+      next->queue.push_back(std::move(request));
+      next->occupancy.add(1, now);
+    }
+    next->not_empty.notify_one();
+  }
+}
+} // namespace nntrainer
@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   staged_pipeline.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Multi-stage layer pipeline with bounded queues header file
+ */
+
+#ifndef STAGED_PIPELINE_HPP
+#define STAGED_PIPELINE_HPP
+
+#pragma once
+#include "prefetch_engine.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nntrainer {
+
+/**
+ * @brief StagedPipeline passes every item, e.g. a layer step, through a chain
+ * of stages such as read and transform. Each stage owns a fixed number of
+ * long-lived threads, the work a stage splits an item into runs on the shared
+ * ThreadPoolManager pool. The stage threads only hand work to the pool and
+ * wait for it, so they are not taken from the pool's budget. A bounded queue sits in front of every stage but the
+ * first, so a fast stage blocks instead of running away from a slow one. The
+ * caller is the last stage, the consumer: it takes finished items in its own
+ * order and reports the time it spends on them and waits for them.
+ *
+ * Every stage is charged the time the others were held up by it: the stage
+ * after it, or the consumer, waiting for an item it still holds, the stage
+ * before it waiting for room in its queue. The consumer is charged the time
+ * the stages report with addBlocked(). The stage with the most of that time
+ * is the bottleneck.
+ *
+ */
+class StagedPipeline {
+public:
+  /**
+   * @brief Function of a stage. The flag is set when the item is cancelled,
+   * the function should then stop as soon as possible.
+   *
+   */
+  using StageFunc = std::function<void(int, const std::atomic<bool> &)>;
+
+  /**
+   * @brief A stage of the pipeline
+   *
+   */
+  struct Stage {
+    std::string name;
+    std::size_t threads = 1;
+    std::size_t capacity = 0; /**< items the queue in front of the stage
+                                 holds, 0 for unbounded. Ignored for the first
+                                 stage, the caller bounds what it submits */
+    StageFunc func;
+  };
+
+  /**
+   * @brief What a stage did since the pipeline was created
+   *
+   */
+  struct StageStats {
+    std::string name;
+    std::size_t threads = 0;
+    std::size_t items = 0;   /**< items that went through the stage */
+    double busy_ms = 0.0;    /**< summed over the threads of the stage,
+                                without time reported with addBlocked() */
+    double utilization = 0.0; /**< busy_ms / (threads * elapsed) */
+    double holding_ms = 0.0; /**< time other stages waited on this one */
+    double mean_queue = 0.0; /**< time averaged items waiting for the stage */
+    std::size_t max_queue = 0;
+    std::size_t capacity = 0; /**< 0 for unbounded */
+  };
+
+  /**
+   * @brief Construct a new Staged Pipeline object
+   *
+   * @param stages stages in the order items go through them
+   * @param consumer name of the consumer stage in the statistics
+   * @throws std::invalid_argument if there is no stage or a stage without
+   * threads
+   */
+  StagedPipeline(std::vector<Stage> stages, std::string consumer);
+
+  /**
+   * @brief Destroy the Staged Pipeline object. Finishes submitted items first.
+   *
+   */
+  ~StagedPipeline();
+
+  StagedPipeline(const StagedPipeline &) = delete;
+  StagedPipeline &operator=(const StagedPipeline &) = delete;
+
+  /**
+   * @brief Queue an item at the first stage. Never blocks.
+   *
+   * @param item item id, passed to every stage
+   * @return PrefetchHandle handle that is done once the last stage finished
+   * the item, with the first exception a stage threw
+   */
+  PrefetchHandle submit(int item);
+
+  /**
+   * @brief Mark that the consumer starts on an item. The item leaves the
+   * consumer queue, or never enters it if the stages are still busy with it.
+   *
+   * @param handle handle of the item
+   */
+  void beginConsume(const PrefetchHandle &handle);
+
+  /**
+   * @brief Mark that the consumer is done with the item of the last
+   * beginConsume()
+   *
+   * @param busy_ms time the consumer worked on the item, without waiting
+   * @param waited_ms time the consumer waited for the item, charged to the
+   * stage that held it at beginConsume()
+   */
+  void endConsume(double busy_ms, double waited_ms = 0.0);
+
+  /**
+   * @brief Report time the calling stage function spent blocked on the
+   * consumer, e.g. waiting for a layer slot the consumer frees. It is not
+   * counted as busy time of the stage but as time the consumer held it up.
+   *
+   * @param ms blocked time in milliseconds
+   */
+  static void addBlocked(double ms);
+
+  /**
+   * @brief Block until every submitted item has left the last stage
+   *
+   */
+  void drain();
+
+  /**
+   * @brief Get the number of items still in the stages
+   *
+   * @return std::size_t number of unfinished items
+   */
+  std::size_t getPending() const;
+
+  /**
+   * @brief Get the statistics of every stage, the consumer last
+   *
+   * @return std::vector<StageStats> statistics in stage order
+   */
+  std::vector<StageStats> getStats() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+  using Request = PrefetchHandle::Request;
+
+  /**
+   * @brief Item count of a queue integrated over time
+   *
+   */
+  struct Occupancy {
+    std::size_t size = 0;
+    std::size_t max = 0;
+    double area = 0.0; /**< item milliseconds */
+    Clock::time_point last_change;
+
+    /**
+     * @brief Change the item count
+     *
+     * @param delta added items, negative for removed ones
+     * @param now current time
+     */
+    void add(long delta, Clock::time_point now);
+  };
+
+  /**
+   * @brief Runtime state of a stage
+   *
+   */
+  struct StageState {
+    Stage stage;
+    std::deque<std::shared_ptr<Request>> queue;
+    Occupancy occupancy;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::vector<std::thread> workers;
+    bool stop = false;
+    std::size_t items = 0;
+    double busy_ms = 0.0;
+    double holding_ms = 0.0;
+  };
+
+  /**
+   * @brief Worker thread body of a stage
+   *
+   * @param index stage index
+   */
+  void worker(std::size_t index);
+
+  /**
+   * @brief Resolve the handle of an item that left the stages, lock held
+   *
+   * @param request the item
+   * @param error exception of the stage that failed, or nullptr
+   */
+  void finish(const std::shared_ptr<Request> &request,
+              std::exception_ptr error);
+
+  std::vector<std::unique_ptr<StageState>> stages;
+  std::string consumer_name;
+  Occupancy consumer_queue;
+  std::vector<std::shared_ptr<Request>> ready; /**< left the stages, not
+                                                  consumed yet */
+  std::size_t consumer_items = 0;
+  double consumer_busy_ms = 0.0;
+  double consumer_holding_ms = 0.0;
+  std::size_t consuming_stage = 0; /**< stage that held the consumed item */
+  std::size_t pending = 0;
+  Clock::time_point created;
+  mutable std::mutex pipeline_mutex;
+  std::condition_variable pending_cv;
+};
+} // namespace nntrainer
+
+#endif // STAGED_PIPELINE_HPP
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   stream_copy.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Copy kernels for staging layers into their slots source file
+ */
+
+#include "stream_copy.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define STREAM_COPY_X86 1
+#endif
+
+namespace nntrainer {
+
+namespace {
+#ifdef STREAM_COPY_X86
+// bytes up to the next multiple of alignment, at most size
+std::size_t head_bytes(const void *dst, std::size_t alignment,
+                       std::size_t size) {
+  std::size_t misalign = reinterpret_cast<std::uintptr_t>(dst) % alignment;
+  return std::min(size, misalign == 0 ? 0 : alignment - misalign);
+}
+
+bool has_erms() {
+  unsigned int eax, ebx, ecx, edx;
+  return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 9));
+}
+
+void copy_movsb(char *dst, const char *src, std::size_t size) {
+  asm volatile("rep movsb"
+               : "+D"(dst), "+S"(src), "+c"(size)
+               :
+               : "memory");
+}
+
+__attribute__((target("avx2"))) void
+copy_avx2_stream(char *dst, const char *src, std::size_t size) {
+  // stores must be 32 byte aligned, the loads need not be
+  std::size_t head = head_bytes(dst, 32, size);
+  std::memcpy(dst, src, head);
+  std::size_t i = head;
+  for (; i + 128 <= size; i += 128) {
+    const __m256i *s = reinterpret_cast<const __m256i *>(src + i);
+    __m256i *d = reinterpret_cast<__m256i *>(dst + i);
+    __m256i v0 = _mm256_loadu_si256(s);
+    __m256i v1 = _mm256_loadu_si256(s + 1);
+    __m256i v2 = _mm256_loadu_si256(s + 2);
+    __m256i v3 = _mm256_loadu_si256(s + 3);
+    _mm256_stream_si256(d, v0);
+    _mm256_stream_si256(d + 1, v1);
+    _mm256_stream_si256(d + 2, v2);
+    _mm256_stream_si256(d + 3, v3);
+  }
+  for (; i + 32 <= size; i += 32)
+    _mm256_stream_si256(
+      reinterpret_cast<__m256i *>(dst + i),
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)));
+  std::memcpy(dst + i, src + i, size - i);
+  _mm_sfence();
+}
+
+__attribute__((target("avx512f"))) void
+copy_avx512_stream(char *dst, const char *src, std::size_t size) {
+  std::size_t head = head_bytes(dst, 64, size);
+  std::memcpy(dst, src, head);
+  std::size_t i = head;
+  for (; i + 256 <= size; i += 256) {
+    __m512i v0 = _mm512_loadu_si512(src + i);
+    __m512i v1 = _mm512_loadu_si512(src + i + 64);
+    __m512i v2 = _mm512_loadu_si512(src + i + 128);
+    __m512i v3 = _mm512_loadu_si512(src + i + 192);
+    _mm512_stream_si512(reinterpret_cast<__m512i *>(dst + i), v0);
+    _mm512_stream_si512(reinterpret_cast<__m512i *>(dst + i + 64), v1);
+    _mm512_stream_si512(reinterpret_cast<__m512i *>(dst + i + 128), v2);
+    _mm512_stream_si512(reinterpret_cast<__m512i *>(dst + i + 192), v3);
+  }
+  for (; i + 64 <= size; i += 64)
+    _mm512_stream_si512(reinterpret_cast<__m512i *>(dst + i),
+                        _mm512_loadu_si512(src + i));
+  std::memcpy(dst + i, src + i, size - i);
+  _mm_sfence();
+}
+#endif
+} // namespace
+
+bool copyKernelSupported(CopyKernel kernel) {
+  switch (kernel) {
+  case CopyKernel::MEMCPY:
+    return true;
+#ifdef STREAM_COPY_X86
+  case CopyKernel::REP_MOVSB:
+    return true;
+  case CopyKernel::AVX2_STREAM:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+  case CopyKernel::AVX512_STREAM:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+#else
+  default:
+    return false;
+#endif
+  }
+  return false;
+}
+
+CopyKernel detectCopyKernel() {
+  if (copyKernelSupported(CopyKernel::AVX512_STREAM))
+    return CopyKernel::AVX512_STREAM;
+  if (copyKernelSupported(CopyKernel::AVX2_STREAM))
+    return CopyKernel::AVX2_STREAM;
+#ifdef STREAM_COPY_X86
+  if (has_erms())
+    return CopyKernel::REP_MOVSB;
+#endif
+  return CopyKernel::MEMCPY;
+}
+
+const char *copyKernelName(CopyKernel kernel) {
+  switch (kernel) {
+  case CopyKernel::MEMCPY:
+    return "memcpy";
+  case CopyKernel::REP_MOVSB:
+    return "movsb";
+  case CopyKernel::AVX2_STREAM:
+    return "avx2";
+  case CopyKernel::AVX512_STREAM:
+    return "avx512";
+  }
+  return "unknown";
+}
+
+void streamCopy(void *dst, const void *src, std::size_t size,
+                CopyKernel kernel) {
+  char *d = static_cast<char *>(dst);
+  const char *s = static_cast<const char *>(src);
+  switch (kernel) {
+#ifdef STREAM_COPY_X86
+  case CopyKernel::REP_MOVSB:
+    copy_movsb(d, s, size);
+    return;
+  case CopyKernel::AVX2_STREAM:
+    copy_avx2_stream(d, s, size);
+    return;
+  case CopyKernel::AVX512_STREAM:
+    copy_avx512_stream(d, s, size);
+    return;
+#endif
+  default:
+    std::memcpy(d, s, size);
+  }
+}
+} // namespace nntrainer
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   stream_copy.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Copy kernels for staging layers into their slots header file
+ *
+ * A layer is copied into its slot long before compute reads it, and is larger
+ * than the last level cache. Copying it through the caches only evicts the
+ * activations and weights compute is working on, so the streaming kernels
+ * write with non-temporal stores that go straight to memory.
+ */
+
+#ifndef STREAM_COPY_HPP
+#define STREAM_COPY_HPP
+
+#pragma once
+#include <cstddef>
+
+namespace nntrainer {
+
+/**
+ * @brief Kernel a copy runs
+ *
+ */
+enum class CopyKernel { MEMCPY, REP_MOVSB, AVX2_STREAM, AVX512_STREAM };
+
+/**
+ * @brief Check whether the CPU can run a copy kernel
+ *
+ * @param kernel copy kernel
+ * @return true if supported
+ */
+bool copyKernelSupported(CopyKernel kernel);
+
+/**
+ * @brief Get the copy kernel to stage layers with: the widest non-temporal
+ * one the CPU supports, else rep movsb where it is fast (ERMS), else memcpy
+ *
+ * @return CopyKernel copy kernel
+ */
+CopyKernel detectCopyKernel();
+
+/**
+ * @brief Get a printable name of the copy kernel
+ *
+ * @param kernel copy kernel
+ * @return const char* name
+ */
+const char *copyKernelName(CopyKernel kernel);
+
+/**
+ * @brief Copy memory with the given kernel. The streaming kernels are done
+ * with a store fence, so other threads see the copy once it returns.
+ *
+ * @param dst destination, any alignment
+ * @param src source, must not overlap dst
+ * @param size number of bytes
+ * @param kernel kernel to run, must be supported by the CPU
+ */
+void streamCopy(void *dst, const void *src, std::size_t size,
+                CopyKernel kernel);
+} // namespace nntrainer
+
+#endif // STREAM_COPY_HPP
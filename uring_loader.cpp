@@ -0,0 +1,320 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   uring_loader.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  io_uring based layer loader source file
+ */
+
+#include "uring_loader.hpp"
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace nntrainer {
+
+namespace {
+int uring_setup(unsigned int entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uring_enter(int ring_fd, unsigned int to_submit, unsigned int min_complete,
+                unsigned int flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+int uring_register(int ring_fd, unsigned int opcode, const void *arg,
+                   unsigned int nr_args) {
+  return static_cast<int>(
+    syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+void *map_ring(std::size_t size, int ring_fd, off_t offset) {
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+  return ptr == MAP_FAILED ? nullptr : ptr;
+}
+} // namespace
+
+UringLoader::UringLoader(int fd, unsigned int queue_depth,
+                         std::size_t chunk_size) :
+  file_fd(fd), queue_depth(queue_depth), chunk_size(chunk_size) {
+  if (queue_depth == 0 || chunk_size == 0)
+    throw std::invalid_argument("queue depth and chunk size must be positive");
+
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  ring_fd = uring_setup(queue_depth, &params);
+  if (ring_fd < 0)
+    throw std::runtime_error(std::string("io_uring_setup failed: ") +
+                             std::strerror(errno));
+
+  sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+  cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap)
+    sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+  sq_ring_ptr = map_ring(sq_ring_size, ring_fd, IORING_OFF_SQ_RING);
+  cq_ring_ptr = single_mmap
+                  ? sq_ring_ptr
+                  : map_ring(cq_ring_size, ring_fd, IORING_OFF_CQ_RING);
+  sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  sqes = static_cast<io_uring_sqe *>(
+    map_ring(sqes_size, ring_fd, IORING_OFF_SQES));
+  if (!sq_ring_ptr || !cq_ring_ptr || !sqes) {
+    const int err = errno;
+    release();
+    throw std::runtime_error(std::string("io_uring ring mmap failed: ") +
+                             std::strerror(err));
+  }
+
+  char *sq = static_cast<char *>(sq_ring_ptr);
+  char *cq = static_cast<char *>(cq_ring_ptr);
+  sq_head = reinterpret_cast<unsigned int *>(sq + params.sq_off.head);
+  sq_tail = reinterpret_cast<unsigned int *>(sq + params.sq_off.tail);
+  sq_mask = reinterpret_cast<unsigned int *>(sq + params.sq_off.ring_mask);
+  sq_array = reinterpret_cast<unsigned int *>(sq + params.sq_off.array);
+  cq_head = reinterpret_cast<unsigned int *>(cq + params.cq_off.head);
+  cq_tail = reinterpret_cast<unsigned int *>(cq + params.cq_off.tail);
+  cq_mask = reinterpret_cast<unsigned int *>(cq + params.cq_off.ring_mask);
+  cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+  submitter = std::thread(&UringLoader::run, this);
+}
+
+UringLoader::~UringLoader() {
+  {
+    std::scoped_lock lock(queue_mutex);
+    stop = true;
+  }
+  queue_cv.notify_one();
+  if (submitter.joinable())
+    submitter.join();
+  release();
+}
+
+void UringLoader::release() {
+  if (sqes)
+    munmap(sqes, sqes_size);
+  if (cq_ring_ptr && cq_ring_ptr != sq_ring_ptr)
+    munmap(cq_ring_ptr, cq_ring_size);
+  if (sq_ring_ptr)
+    munmap(sq_ring_ptr, sq_ring_size);
+  sqes = nullptr;
+  cq_ring_ptr = sq_ring_ptr = nullptr;
+  if (ring_fd >= 0)
+    close(ring_fd);
+  ring_fd = -1;
+}
+
+bool UringLoader::registerBuffers(const std::vector<void *> &buffers,
+                                  std::size_t buffer_size) {
+  std::vector<iovec> iovecs;
+  iovecs.reserve(buffers.size());
+  for (void *buffer : buffers)
+    iovecs.push_back({buffer, buffer_size});
+
+  buffers_registered =
+    uring_register(ring_fd, IORING_REGISTER_BUFFERS, iovecs.data(),
+                   static_cast<unsigned int>(iovecs.size())) == 0;
+  return buffers_registered;
+}
+
+std::future<std::size_t>
+UringLoader::read(void *dst, std::size_t len, std::size_t offset,
+                  int buf_index, std::function<void()> on_complete,
+                  int priority, const std::atomic<bool> *cancelled) {
+  auto req = std::make_unique<Request>();
+  req->dst = static_cast<char *>(dst);
+  req->len = len;
+  req->offset = offset;
+  req->buf_index = buf_index;
+  req->on_complete = std::move(on_complete);
+  req->priority = priority;
+  req->cancelled = cancelled;
+  std::future<std::size_t> done = req->done.get_future();
+  {
+    std::scoped_lock lock(queue_mutex);
+    queue.push_back(std::move(req));
+  }
+  queue_cv.notify_one();
+  return done;
+}
+
+void UringLoader::prepare(Piece *piece) {
+  const unsigned int tail = *sq_tail;
+  const unsigned int index = tail & *sq_mask;
+  io_uring_sqe *sqe = &sqes[index];
+
+  std::memset(sqe, 0, sizeof(*sqe));
+  if (buffers_registered && piece->req->buf_index >= 0) {
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->buf_index = static_cast<std::uint16_t>(piece->req->buf_index);
+  } else {
+    sqe->opcode = IORING_OP_READ;
+  }
+  sqe->fd = file_fd;
+  sqe->addr = reinterpret_cast<std::uint64_t>(piece->dst);
+  sqe->len = static_cast<std::uint32_t>(piece->len);
+  sqe->off = piece->offset;
+  sqe->user_data = reinterpret_cast<std::uint64_t>(piece);
+
+  sq_array[index] = index;
+  __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+unsigned int UringLoader::reap(std::deque<Piece *> &retry) {
+  unsigned int head = *cq_head;
+  unsigned int reaped = 0;
+
+  while (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+    const io_uring_cqe *cqe = &cqes[head & *cq_mask];
+    Piece *piece = reinterpret_cast<Piece *>(cqe->user_data);
+    const int res = cqe->res;
+    ++head;
+    ++reaped;
+
+    if (res == -EINTR || res == -EAGAIN) {
+      retry.push_back(piece);
+      continue;
+    }
+
+    Request *req = piece->req;
+    if (res > 0)
+      req->completed += res;
+    if (res <= 0) {
+      req->error = res < 0 ? -res : EIO;
+    } else if (static_cast<std::size_t>(res) < piece->len) {
+      piece->dst += res;
+      piece->offset += res;
+      piece->len -= res;
+      retry.push_back(piece);
+      continue;
+    }
+    --req->inflight;
+    delete piece;
+  }
+
+  __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+  return reaped;
+}
+
+bool UringLoader::finish(Request *req) {
+  if (req->inflight > 0 || (!req->stopped() && req->issued < req->len))
+    return false;
+
+  if (req->on_complete)
+    req->on_complete();
+  if (req->error != 0)
+    req->done.set_exception(std::make_exception_ptr(std::system_error(
+      req->error, std::generic_category(), "io_uring read failed")));
+  else
+    req->done.set_value(req->completed);
+  return true;
+}
+
+void UringLoader::run() {
+  std::deque<std::unique_ptr<Request>> active;
+  std::deque<Piece *> retry;
+  unsigned int inflight = 0;
+  unsigned int unsubmitted = 0;
+
+  while (true) {
+    {
+      std::unique_lock lock(queue_mutex);
+      if (active.empty())
+        queue_cv.wait(lock, [this] { return stop || !queue.empty(); });
+      if (stop && queue.empty() && active.empty())
+        break;
+      while (!queue.empty()) {
+        active.push_back(std::move(queue.front()));
+        queue.pop_front();
+      }
+    }
+
+    while (ring_error == 0 && inflight < queue_depth) {
+      Piece *piece = nullptr;
+      if (!retry.empty()) {
+        piece = retry.front();
+        retry.pop_front();
+        if (piece->req->stopped()) {
+          --piece->req->inflight;
+          delete piece;
+          continue;
+        }
+      } else {
+        Request *next = nullptr;
+        for (auto &req : active) {
+          if (req->stopped() || req->issued >= req->len)
+            continue;
+          if (!next || req->priority > next->priority)
+            next = req.get();
+        }
+        if (next) {
+          const std::size_t len =
+            std::min(chunk_size, next->len - next->issued);
+          piece = new Piece{next, next->dst + next->issued, len,
+                            next->offset + next->issued};
+          next->issued += len;
+          ++next->inflight;
+        }
+      }
+      if (!piece)
+        break;
+      prepare(piece);
+      ++inflight;
+      ++unsubmitted;
+    }
+
+    if (inflight > 0) {
+      const int ret = uring_enter(ring_fd, unsubmitted, 1,
+                                  IORING_ENTER_GETEVENTS);
+      if (ret > 0)
+        unsubmitted -= std::min(unsubmitted, static_cast<unsigned int>(ret));
+      else if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+        ring_error = errno;
+      inflight -= reap(retry);
+    }
+
+    if (ring_error != 0) {
+      // the ring is unusable: pieces still in flight are never reaped, so
+      // fail their requests now instead of waiting for them, and every
+      // request queued later as well
+      release();
+      for (Piece *piece : retry)
+        delete piece;
+      retry.clear();
+      for (auto &req : active) {
+        if (req->error == 0)
+          req->error = ring_error;
+        req->inflight = 0;
+      }
+      inflight = unsubmitted = 0;
+    }
+
+    for (auto it = active.begin(); it != active.end();) {
+      if (finish(it->get()))
+        it = active.erase(it);
+      else
+        ++it;
+    }
+  }
+}
+} // namespace nntrainer
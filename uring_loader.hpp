@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   uring_loader.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  io_uring based layer loader header file
+ */
+
+#ifndef URING_LOADER_HPP
+#define URING_LOADER_HPP
+
+#pragma once
+#include <linux/io_uring.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nntrainer {
+/**
+ * @brief UringLoader reads file ranges straight into caller-owned buffers
+ * through io_uring. A single submitter thread owns the ring, splits every
+ * request into chunk sized reads and keeps up to queue_depth of them in flight.
+ * Free ring entries go to the pending request with the highest priority, so an
+ * urgent request overtakes the rest of a large one already in progress.
+ *
+ */
+class UringLoader {
+public:
+  /**
+   * @brief Construct a new Uring Loader object
+   *
+   * @param fd file descriptor to read from (may be opened with O_DIRECT)
+   * @param queue_depth maximum number of reads in flight
+   * @param chunk_size size of a single read submitted to the ring
+   * @throws std::runtime_error if the ring can not be set up
+   */
+  UringLoader(int fd, unsigned int queue_depth, std::size_t chunk_size);
+
+  /**
+   * @brief Destroy the Uring Loader object. Waits for queued reads to finish.
+   *
+   */
+  ~UringLoader();
+
+  UringLoader(const UringLoader &) = delete;
+  UringLoader &operator=(const UringLoader &) = delete;
+
+  /**
+   * @brief Register destination buffers with the ring so that reads into them
+   * can use IORING_OP_READ_FIXED. Must be called before the first read.
+   *
+   * @param buffers buffers to register, index in this vector is the buf_index
+   * @param buffer_size size of each buffer
+   * @return true if registration succeeded, false otherwise (errno is set)
+   */
+  bool registerBuffers(const std::vector<void *> &buffers,
+                       std::size_t buffer_size);
+
+  /**
+   * @brief Queue a read of [offset, offset + len) into dst
+   *
+   * @param dst destination buffer
+   * @param len number of bytes to read
+   * @param offset file offset to read from
+   * @param buf_index index of the registered buffer dst lies in, or -1
+   * @param on_complete called from the submitter thread as soon as the last
+   * read completes (or the request fails), before the future is resolved
+   * @param priority requests with a higher priority are issued first, equal
+   * priorities in the order they were queued
+   * @param cancelled once set, no further reads of the request are issued and
+   * it finishes as soon as the reads in flight complete, may be nullptr
+   * @return std::future<std::size_t> number of bytes read, ready once every
+   * byte has landed in dst or the request was cancelled
+   */
+  std::future<std::size_t> read(void *dst, std::size_t len,
+                                std::size_t offset, int buf_index = -1,
+                                std::function<void()> on_complete = nullptr,
+                                int priority = 0,
+                                const std::atomic<bool> *cancelled = nullptr);
+
+  /**
+   * @brief Check whether buffers are registered with the ring
+   *
+   * @return true if reads may use registered buffers
+   */
+  bool hasRegisteredBuffers() const { return buffers_registered; }
+
+private:
+  /**
+   * @brief A read request as queued by read()
+   *
+   */
+  struct Request {
+    char *dst = nullptr;
+    std::size_t len = 0;
+    std::size_t offset = 0;
+    int buf_index = -1;
+    int priority = 0;
+    const std::atomic<bool> *cancelled = nullptr;
+    std::size_t issued = 0;
+    std::size_t completed = 0;
+    unsigned int inflight = 0;
+    int error = 0;
+    std::function<void()> on_complete;
+    std::promise<std::size_t> done;
+
+    /**
+     * @brief Check whether no further reads of the request may be issued
+     *
+     */
+    bool stopped() const {
+      return error != 0 ||
+             (cancelled && cancelled->load(std::memory_order_acquire));
+    }
+  };
+
+  /**
+   * @brief A single chunk read in flight on the ring
+   *
+   */
+  struct Piece {
+    Request *req;
+    char *dst;
+    std::size_t len;
+    std::size_t offset;
+  };
+
+  /**
+   * @brief Submitter thread body
+   *
+   */
+  void run();
+
+  /**
+   * @brief Fill one submission queue entry for the given piece
+   *
+   * @param piece chunk to read
+   */
+  void prepare(Piece *piece);
+
+  /**
+   * @brief Reap completions from the completion queue
+   *
+   * @param retry list of pieces that completed short and must be resubmitted
+   * @return unsigned int number of completions reaped
+   */
+  unsigned int reap(std::deque<Piece *> &retry);
+
+  /**
+   * @brief Resolve the request's future once nothing is left to issue or wait
+   *
+   * @param req request to check
+   * @return true if the request is finished
+   */
+  static bool finish(Request *req);
+
+  /**
+   * @brief Unmap the rings and close the ring file descriptor
+   *
+   */
+  void release();
+
+  int file_fd;
+  int ring_fd = -1;
+  unsigned int queue_depth;
+  std::size_t chunk_size;
+  bool buffers_registered = false;
+
+  void *sq_ring_ptr = nullptr;
+  std::size_t sq_ring_size = 0;
+  void *cq_ring_ptr = nullptr;
+  std::size_t cq_ring_size = 0;
+  io_uring_sqe *sqes = nullptr;
+  std::size_t sqes_size = 0;
+
+  unsigned int *sq_head = nullptr;
+  unsigned int *sq_tail = nullptr;
+  unsigned int *sq_mask = nullptr;
+  unsigned int *sq_array = nullptr;
+  unsigned int *cq_head = nullptr;
+  unsigned int *cq_tail = nullptr;
+  unsigned int *cq_mask = nullptr;
+  io_uring_cqe *cqes = nullptr;
+
+  std::deque<std::unique_ptr<Request>> queue;
+  std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  bool stop = false;
+  int ring_error = 0; /**< errno of a failed io_uring_enter, the ring is no
+                         longer used once it is set */
+  std::thread submitter;
+};
+} // namespace nntrainer
+
+#endif // URING_LOADER_HPP
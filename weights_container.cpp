@@ -0,0 +1,569 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   weights_container.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Indexed weights container source file
+ */
+
+#include "weights_container.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace nntrainer {
+
+namespace {
+constexpr char CONTAINER_MAGIC[8] = {'N', 'N', 'W', 'E', 'I', 'G', 'H', 'T'};
+constexpr std::uint32_t CONTAINER_VERSION = 1;
+constexpr std::uint32_t COMPRESSED_CONTAINER_VERSION = 2;
+constexpr std::size_t MAX_TENSOR_NAME = 40;
+
+/**
+ * @brief Fixed size container header at file offset 0
+ *
+ */
+struct ContainerHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t num_layers;
+  std::uint32_t num_tensors;
+  std::uint32_t num_blocks; /**< 0 unless the layers are compressed */
+  std::uint64_t layer_alignment;
+  std::uint64_t tensor_alignment;
+  std::uint64_t data_offset;
+  std::uint64_t file_size;
+};
+static_assert(sizeof(ContainerHeader) == 56, "unexpected header padding");
+
+/**
+ * @brief Index entry of a layer
+ *
+ */
+struct LayerRecord {
+  std::uint64_t offset;
+  std::uint64_t size;
+  std::uint32_t first_tensor;
+  std::uint32_t num_tensors;
+};
+static_assert(sizeof(LayerRecord) == 24, "unexpected layer record padding");
+
+/**
+ * @brief Index entry of a tensor
+ *
+ */
+struct TensorRecord {
+  char name[MAX_TENSOR_NAME];
+  std::uint32_t dtype;
+  std::uint32_t rows;
+  std::uint32_t cols;
+  std::uint32_t expert; /**< expert + 1, 0 for shared tensors */
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+static_assert(sizeof(TensorRecord) == 72, "unexpected tensor record padding");
+
+/**
+ * @brief Index entry of a compressed block
+ *
+ */
+struct BlockRecord {
+  std::uint64_t offset; /**< offset in the uncompressed layout */
+  std::uint64_t file_offset;
+  std::uint32_t size;
+  std::uint32_t stored_size;
+  std::uint32_t codec;
+  std::uint32_t reserved;
+};
+static_assert(sizeof(BlockRecord) == 32, "unexpected block record padding");
+
+std::size_t align_up(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+bool is_pow2(std::size_t value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+void read_exact(int fd, void *buf, std::size_t size, std::size_t offset) {
+  char *dst = static_cast<char *>(buf);
+  while (size > 0) {
+    ssize_t ret = pread(fd, dst, size, offset);
+    if (ret <= 0)
+      throw std::runtime_error("failed to read weights container index");
+    dst += ret;
+    offset += ret;
+    size -= ret;
+  }
+}
+} // namespace
+
+std::size_t dtypeBytes(DType dtype, std::size_t elements) {
+  switch (dtype) {
+  case DType::F32:
+    return elements * 4;
+  case DType::F16:
+  case DType::BF16:
+    return elements * 2;
+  case DType::Q4:
+    return (elements + 1) / 2;
+  case DType::I8:
+    return elements;
+  }
+  throw std::invalid_argument("unknown dtype");
+}
+
+const char *dtypeName(DType dtype) {
+  switch (dtype) {
+  case DType::F32:
+    return "f32";
+  case DType::F16:
+    return "f16";
+  case DType::BF16:
+    return "bf16";
+  case DType::Q4:
+    return "q4";
+  case DType::I8:
+    return "i8";
+  }
+  return "unknown";
+}
+
+const char *blockCodecName(BlockCodec codec) {
+  switch (codec) {
+  case BlockCodec::NONE:
+    return "none";
+  case BlockCodec::DEFLATE:
+    return "deflate";
+  }
+  return "unknown";
+}
+
+WeightsIndex::WeightsIndex(std::size_t layer_alignment,
+                           std::size_t tensor_alignment) :
+  layer_alignment(layer_alignment),
+  tensor_alignment(tensor_alignment),
+  container(true) {
+  // layers are mapped and read with O_DIRECT at their offsets, which must
+  // therefore be page aligned
+  if (!is_pow2(layer_alignment) || !is_pow2(tensor_alignment) ||
+      layer_alignment < DEFAULT_ALIGNMENT ||
+      tensor_alignment > layer_alignment)
+    throw std::invalid_argument("invalid weights container alignment");
+}
+
+bool WeightsIndex::isContainer(int fd) {
+  char magic[sizeof(CONTAINER_MAGIC)];
+  return pread(fd, magic, sizeof(magic), 0) ==
+           static_cast<ssize_t>(sizeof(magic)) &&
+         std::memcmp(magic, CONTAINER_MAGIC, sizeof(magic)) == 0;
+}
+
+WeightsIndex WeightsIndex::read(int fd) {
+  ContainerHeader header;
+  read_exact(fd, &header, sizeof(header), 0);
+  if (std::memcmp(header.magic, CONTAINER_MAGIC, sizeof(CONTAINER_MAGIC)) != 0)
+    throw std::runtime_error("not a weights container");
+  if (header.version != CONTAINER_VERSION &&
+      header.version != COMPRESSED_CONTAINER_VERSION)
+    throw std::runtime_error("unsupported weights container version " +
+                             std::to_string(header.version));
+
+  if (header.layer_alignment < DEFAULT_ALIGNMENT)
+    throw std::runtime_error("weights container layer alignment " +
+                             std::to_string(header.layer_alignment) +
+                             " is below " + std::to_string(DEFAULT_ALIGNMENT));
+  WeightsIndex index(header.layer_alignment, header.tensor_alignment);
+
+  std::vector<LayerRecord> layer_records(header.num_layers);
+  std::vector<TensorRecord> tensor_records(header.num_tensors);
+  std::size_t offset = sizeof(header);
+  read_exact(fd, layer_records.data(),
+             layer_records.size() * sizeof(LayerRecord), offset);
+  offset += layer_records.size() * sizeof(LayerRecord);
+  read_exact(fd, tensor_records.data(),
+             tensor_records.size() * sizeof(TensorRecord), offset);
+  offset += tensor_records.size() * sizeof(TensorRecord);
+  std::vector<BlockRecord> block_records;
+  if (header.version == COMPRESSED_CONTAINER_VERSION) {
+    block_records.resize(header.num_blocks);
+    read_exact(fd, block_records.data(),
+               block_records.size() * sizeof(BlockRecord), offset);
+  }
+  const bool compressed = !block_records.empty();
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<std::size_t>(st.st_size) < header.file_size)
+    throw std::runtime_error("weights container is truncated");
+
+  for (const auto &record : layer_records) {
+    if (record.offset % index.layer_alignment != 0 ||
+        record.size % index.layer_alignment != 0 ||
+        record.offset < header.data_offset ||
+        (!compressed && record.offset + record.size > header.file_size) ||
+        static_cast<std::uint64_t>(record.first_tensor) + record.num_tensors >
+          header.num_tensors)
+      throw std::runtime_error("malformed layer record in weights container");
+
+    LayerInfo layer;
+    layer.offset = record.offset;
+    layer.size = record.size;
+    for (std::uint32_t t = 0; t < record.num_tensors; ++t) {
+      const TensorRecord &tr = tensor_records[record.first_tensor + t];
+      TensorInfo tensor;
+      tensor.name.assign(tr.name, strnlen(tr.name, MAX_TENSOR_NAME));
+      tensor.dtype = static_cast<DType>(tr.dtype);
+      tensor.rows = tr.rows;
+      tensor.cols = tr.cols;
+      tensor.offset = tr.offset;
+      tensor.size = tr.size;
+      tensor.expert = static_cast<std::int32_t>(tr.expert) - 1;
+      // compute takes rows and cols as they are, the bytes must match them
+      std::uint64_t elements;
+      bool shape_ok =
+        tr.dtype <= static_cast<std::uint32_t>(DType::I8) &&
+        !__builtin_mul_overflow(static_cast<std::uint64_t>(tr.rows), tr.cols,
+                                &elements) &&
+        elements <= SIZE_MAX / 4 &&
+        tensor.size == dtypeBytes(tensor.dtype, elements) &&
+        (tensor.dtype != DType::Q4 || tensor.cols % 2 == 0);
+      if (!shape_ok || tensor.offset % index.tensor_alignment != 0 ||
+          tensor.size > layer.size || tensor.offset > layer.size - tensor.size)
+        throw std::runtime_error("malformed tensor record '" + tensor.name +
+                                 "' in weights container");
+      layer.tensors.push_back(std::move(tensor));
+    }
+    try {
+      index.layoutExperts(layer);
+    } catch (const std::invalid_argument &e) {
+      throw std::runtime_error(std::string("malformed expert layout in "
+                                           "weights container: ") +
+                               e.what());
+    }
+    index.layers.push_back(std::move(layer));
+  }
+
+  // blocks must tile the layers back to back and stay inside the file
+  std::size_t next = index.layers.empty() ? 0 : index.layers.front().offset;
+  for (const auto &record : block_records) {
+    BlockInfo block;
+    block.offset = record.offset;
+    block.size = record.size;
+    block.file_offset = record.file_offset;
+    block.stored_size = record.stored_size;
+    block.codec = static_cast<BlockCodec>(record.codec);
+    if (block.offset != next || block.size == 0 ||
+        record.codec > static_cast<std::uint32_t>(BlockCodec::DEFLATE) ||
+        (block.codec == BlockCodec::NONE &&
+         block.stored_size != block.size) ||
+        block.file_offset % DEFAULT_ALIGNMENT != 0 ||
+        block.file_offset < header.data_offset ||
+        block.file_offset + block.stored_size > header.file_size)
+      throw std::runtime_error("malformed block record in weights container");
+    next += block.size;
+    index.block_list.push_back(block);
+  }
+  try {
+    for (const auto &layer : index.layers) {
+      if (!compressed)
+        break;
+      index.blockRange(layer.offset, layer.size);
+      index.blockRange(layer.offset, layer.dense_size);
+      for (const auto &expert : layer.experts)
+        index.blockRange(layer.offset + expert.offset, expert.size);
+    }
+  } catch (const std::invalid_argument &e) {
+    throw std::runtime_error(std::string("malformed block layout in "
+                                         "weights container: ") +
+                             e.what());
+  }
+  return index;
+}
+
+WeightsIndex WeightsIndex::uniform(std::size_t num_layers,
+                                   const std::vector<TensorInfo> &tensors) {
+  WeightsIndex index;
+  index.container = false;
+  for (std::size_t i = 0; i < num_layers; ++i)
+    index.addLayer(tensors);
+  return index;
+}
+
+std::vector<TensorInfo> WeightsIndex::decoderLayer(std::uint32_t hidden,
+                                                   std::uint32_t kv_dim,
+                                                   std::uint32_t ffn) {
+  return {
+    {"attn_q", DType::Q4, hidden, hidden, 0, 0},
+    {"attn_k", DType::Q4, kv_dim, hidden, 0, 0},
+    {"attn_v", DType::Q4, kv_dim, hidden, 0, 0},
+    {"attn_o", DType::Q4, hidden, hidden, 0, 0},
+    {"ffn_gate", DType::Q4, ffn, hidden, 0, 0},
+    {"ffn_up", DType::Q4, ffn, hidden, 0, 0},
+    {"ffn_down", DType::Q4, ffn, ffn, 0, 0},
+  };
+}
+
+std::vector<TensorInfo> WeightsIndex::moeLayer(std::uint32_t hidden,
+                                               std::uint32_t kv_dim,
+                                               std::uint32_t expert_ffn,
+                                               std::uint32_t num_experts) {
+  std::vector<TensorInfo> tensors = {
+    {"attn_q", DType::Q4, hidden, hidden, 0, 0},
+    {"attn_k", DType::Q4, kv_dim, hidden, 0, 0},
+    {"attn_v", DType::Q4, kv_dim, hidden, 0, 0},
+    {"attn_o", DType::Q4, hidden, hidden, 0, 0},
+    {"ffn_gate_inp", DType::F32, num_experts, hidden, 0, 0},
+  };
+  for (std::uint32_t e = 0; e < num_experts; ++e) {
+    std::string suffix = "." + std::to_string(e);
+    std::int32_t expert = static_cast<std::int32_t>(e);
+    tensors.push_back(
+      {"ffn_gate" + suffix, DType::Q4, expert_ffn, hidden, 0, 0, expert});
+    tensors.push_back(
+      {"ffn_up" + suffix, DType::Q4, expert_ffn, hidden, 0, 0, expert});
+    tensors.push_back(
+      {"ffn_down" + suffix, DType::Q4, hidden, expert_ffn, 0, 0, expert});
+  }
+  return tensors;
+}
+
+void WeightsIndex::addLayer(std::vector<TensorInfo> tensors) {
+  LayerInfo layer;
+  std::size_t offset = 0;
+  for (auto &tensor : tensors) {
+    if (tensor.name.size() >= MAX_TENSOR_NAME)
+      throw std::invalid_argument("tensor name too long: " + tensor.name);
+    offset = align_up(offset, tensor_alignment);
+    tensor.offset = offset;
+    tensor.size = dtypeBytes(tensor.dtype,
+                             static_cast<std::size_t>(tensor.rows) * tensor.cols);
+    offset += tensor.size;
+  }
+  layer.size = align_up(offset, layer_alignment);
+  layer.tensors = std::move(tensors);
+  layoutExperts(layer);
+  layers.push_back(std::move(layer));
+  placeLayers();
+}
+
+void WeightsIndex::splitBlocks(std::size_t block_size) {
+  if (block_size == 0 || block_size % DEFAULT_ALIGNMENT != 0)
+    throw std::invalid_argument("block size must be a multiple of " +
+                                std::to_string(DEFAULT_ALIGNMENT));
+
+  block_list.clear();
+  std::vector<std::size_t> first_block;
+  for (const auto &layer : layers) {
+    first_block.push_back(block_list.size());
+    std::vector<std::size_t> bounds = {0, layer.dense_size, layer.size};
+    for (const auto &expert : layer.experts) {
+      bounds.push_back(expert.offset);
+      bounds.push_back(expert.offset + expert.size);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    for (std::size_t i = 0; i + 1 < bounds.size(); ++i)
+      for (std::size_t at = bounds[i]; at < bounds[i + 1]; at += block_size)
+        block_list.push_back(
+          {at, std::min(block_size, bounds[i + 1] - at), 0, 0});
+  }
+  first_block.push_back(block_list.size());
+
+  // the block records grow the index, place the layers behind it again
+  placeLayers();
+  for (std::size_t l = 0; l < layers.size(); ++l)
+    for (std::size_t b = first_block[l]; b < first_block[l + 1]; ++b)
+      block_list[b].offset += layers[l].offset;
+}
+
+std::size_t WeightsIndex::storeBlock(std::size_t block,
+                                     std::size_t stored_size,
+                                     BlockCodec codec) {
+  BlockInfo &info = block_list.at(block);
+  info.file_offset =
+    block == 0 ? dataOffset()
+               : align_up(block_list[block - 1].file_offset +
+                            block_list[block - 1].stored_size,
+                          DEFAULT_ALIGNMENT);
+  info.stored_size = stored_size;
+  info.codec = codec;
+  return info.file_offset;
+}
+
+std::pair<std::size_t, std::size_t>
+WeightsIndex::blockRange(std::size_t offset, std::size_t length) const {
+  auto before = [](const BlockInfo &block, std::size_t value) {
+    return block.offset < value;
+  };
+  auto first =
+    std::lower_bound(block_list.begin(), block_list.end(), offset, before);
+  auto last = std::lower_bound(first, block_list.end(), offset + length,
+                               before);
+  bool ends_on_block = last == block_list.end()
+                         ? first != last && block_list.back().offset +
+                                                block_list.back().size ==
+                                              offset + length
+                         : last->offset == offset + length;
+  if (first == block_list.end() || first->offset != offset || !ends_on_block)
+    throw std::invalid_argument("range at " + std::to_string(offset) +
+                                " is not made of whole blocks");
+  return {static_cast<std::size_t>(first - block_list.begin()),
+          static_cast<std::size_t>(last - block_list.begin())};
+}
+
+void WeightsIndex::write(int fd) const {
+  std::vector<char> buffer(dataOffset(), 0);
+
+  ContainerHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, CONTAINER_MAGIC, sizeof(CONTAINER_MAGIC));
+  header.version =
+    compressed() ? COMPRESSED_CONTAINER_VERSION : CONTAINER_VERSION;
+  header.num_layers = static_cast<std::uint32_t>(layers.size());
+  header.layer_alignment = layer_alignment;
+  header.tensor_alignment = tensor_alignment;
+  header.data_offset = dataOffset();
+  header.file_size = fileSize();
+
+  char *layer_ptr = buffer.data() + sizeof(header);
+  char *tensor_ptr = layer_ptr + layers.size() * sizeof(LayerRecord);
+  std::uint32_t num_tensors = 0;
+  for (const auto &layer : layers) {
+    LayerRecord record = {layer.offset, layer.size, num_tensors,
+                          static_cast<std::uint32_t>(layer.tensors.size())};
+    std::memcpy(layer_ptr, &record, sizeof(record));
+    layer_ptr += sizeof(record);
+
+    for (const auto &tensor : layer.tensors) {
+      TensorRecord tr;
+      std::memset(&tr, 0, sizeof(tr));
+      std::strncpy(tr.name, tensor.name.c_str(), MAX_TENSOR_NAME - 1);
+      tr.dtype = static_cast<std::uint32_t>(tensor.dtype);
+      tr.rows = tensor.rows;
+      tr.cols = tensor.cols;
+      tr.expert = static_cast<std::uint32_t>(tensor.expert + 1);
+      tr.offset = tensor.offset;
+      tr.size = tensor.size;
+      std::memcpy(tensor_ptr, &tr, sizeof(tr));
+      tensor_ptr += sizeof(tr);
+      ++num_tensors;
+    }
+  }
+  header.num_tensors = num_tensors;
+
+  for (const auto &block : block_list) {
+    BlockRecord record = {block.offset,
+                          block.file_offset,
+                          static_cast<std::uint32_t>(block.size),
+                          static_cast<std::uint32_t>(block.stored_size),
+                          static_cast<std::uint32_t>(block.codec),
+                          0};
+    std::memcpy(tensor_ptr, &record, sizeof(record));
+    tensor_ptr += sizeof(record);
+  }
+  header.num_blocks = static_cast<std::uint32_t>(block_list.size());
+  std::memcpy(buffer.data(), &header, sizeof(header));
+
+  if (pwrite(fd, buffer.data(), buffer.size(), 0) !=
+      static_cast<ssize_t>(buffer.size()))
+    throw std::runtime_error("failed to write weights container index");
+}
+
+std::size_t WeightsIndex::maxLayerSize() const {
+  std::size_t max_size = 0;
+  for (const auto &layer : layers)
+    max_size = std::max(max_size, layer.size);
+  return max_size;
+}
+
+std::size_t WeightsIndex::maxDenseSize() const {
+  std::size_t max_size = 0;
+  for (const auto &layer : layers)
+    max_size = std::max(max_size, layer.dense_size);
+  return max_size;
+}
+
+std::size_t WeightsIndex::maxExpertSize() const {
+  std::size_t max_size = 0;
+  for (const auto &layer : layers)
+    for (const auto &expert : layer.experts)
+      max_size = std::max(max_size, expert.size);
+  return max_size;
+}
+
+std::size_t WeightsIndex::maxExperts() const {
+  std::size_t max_experts = 0;
+  for (const auto &layer : layers)
+    max_experts = std::max(max_experts, layer.experts.size());
+  return max_experts;
+}
+
+std::size_t WeightsIndex::fileSize() const {
+  if (compressed())
+    return align_up(std::max(dataOffset(), block_list.back().file_offset +
+                                             block_list.back().stored_size),
+                    DEFAULT_ALIGNMENT);
+  return layers.empty() ? dataOffset()
+                        : layers.back().offset + layers.back().size;
+}
+
+std::size_t WeightsIndex::dataOffset() const {
+  if (!container)
+    return 0;
+
+  std::size_t num_tensors = 0;
+  for (const auto &layer : layers)
+    num_tensors += layer.tensors.size();
+  return align_up(sizeof(ContainerHeader) +
+                    layers.size() * sizeof(LayerRecord) +
+                    num_tensors * sizeof(TensorRecord) +
+                    block_list.size() * sizeof(BlockRecord),
+                  layer_alignment);
+}
+
+void WeightsIndex::placeLayers() {
+  // the index grows with every layer, so the data start may move
+  std::size_t data = dataOffset();
+  for (auto &layer : layers) {
+    layer.offset = data;
+    data += layer.size;
+  }
+}
+
+void WeightsIndex::layoutExperts(LayerInfo &layer) const {
+  layer.dense_size = layer.size;
+  layer.experts.clear();
+  for (const auto &tensor : layer.tensors) {
+    if (tensor.expert < 0) {
+      if (!layer.experts.empty())
+        throw std::invalid_argument("shared tensor '" + tensor.name +
+                                    "' after an expert");
+      continue;
+    }
+
+    std::size_t expert = static_cast<std::size_t>(tensor.expert);
+    if (expert == layer.experts.size()) {
+      if (layer.experts.empty())
+        layer.dense_size = tensor.offset;
+      layer.experts.push_back({tensor.offset, 0});
+    } else if (expert + 1 != layer.experts.size()) {
+      throw std::invalid_argument("tensors of expert " +
+                                  std::to_string(expert) +
+                                  " are not contiguous");
+    }
+    ExpertInfo &info = layer.experts.back();
+    info.size =
+      align_up(tensor.offset + tensor.size, tensor_alignment) - info.offset;
+  }
+}
+} // namespace nntrainer
@@ -0,0 +1,378 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   weights_container.hpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Indexed weights container header file
+ *
+ * On-disk layout (little endian):
+ *
+ *   ContainerHeader
+ *   LayerRecord  x num_layers
+ *   TensorRecord x num_tensors
+ *   BlockRecord  x num_blocks (version 2 only)
+ *   padding up to data_offset
+ *   layer data, each layer starting at a multiple of layer_alignment and
+ *   padded to a multiple of it; tensors inside a layer start at multiples of
+ *   tensor_alignment
+ *
+ * A version 2 container stores its layers block compressed. Offsets of layers
+ * and tensors then describe the uncompressed layout, the block records map it
+ * to the file: every block is compressed on its own and stored at a multiple
+ * of DEFAULT_ALIGNMENT, so that blocks can be read and inflated in parallel.
+ * Blocks never cross the end of a layer, its shared part or an expert.
+ *
+ * In a mixture-of-experts layer the tensors shared by every token come first,
+ * followed by the tensors of expert 0, expert 1, ... so that every expert is
+ * one contiguous range that can be read on its own.
+ */
+
+#ifndef WEIGHTS_CONTAINER_HPP
+#define WEIGHTS_CONTAINER_HPP
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nntrainer {
+
+/**
+ * @brief Element type of a tensor stored in the container
+ *
+ */
+enum class DType : std::uint32_t { F32 = 0, F16 = 1, BF16 = 2, Q4 = 3, I8 = 4 };
+
+/**
+ * @brief Get the number of bytes needed for the given number of elements
+ *
+ * @param dtype element type
+ * @param elements number of elements
+ * @return std::size_t size in bytes
+ */
+std::size_t dtypeBytes(DType dtype, std::size_t elements);
+
+/**
+ * @brief Get a printable name of the element type
+ *
+ * @param dtype element type
+ * @return const char* name
+ */
+const char *dtypeName(DType dtype);
+
+/**
+ * @brief Compression of a block of a compressed container
+ *
+ */
+enum class BlockCodec : std::uint32_t { NONE = 0, DEFLATE = 1 };
+
+/**
+ * @brief Get a printable name of the block codec
+ *
+ * @param codec block codec
+ * @return const char* name
+ */
+const char *blockCodecName(BlockCodec codec);
+
+/**
+ * @brief A tensor inside a layer
+ *
+ */
+struct TensorInfo {
+  std::string name;
+  DType dtype = DType::Q4;
+  std::uint32_t rows = 0;
+  std::uint32_t cols = 0;
+  std::size_t offset = 0; /**< offset from the start of the layer */
+  std::size_t size = 0;   /**< size in bytes */
+  std::int32_t expert = -1; /**< expert the tensor belongs to, -1 if shared */
+};
+
+/**
+ * @brief The tensors of one expert inside a layer
+ *
+ */
+struct ExpertInfo {
+  std::size_t offset = 0; /**< offset from the start of the layer */
+  std::size_t size = 0;   /**< size in bytes, a multiple of tensor alignment */
+};
+
+/**
+ * @brief A compressed block of layer data
+ *
+ */
+struct BlockInfo {
+  std::size_t offset = 0;      /**< offset in the uncompressed layout */
+  std::size_t size = 0;        /**< uncompressed size in bytes */
+  std::size_t file_offset = 0; /**< file offset of the stored block */
+  std::size_t stored_size = 0; /**< size in bytes as stored */
+  BlockCodec codec = BlockCodec::NONE;
+};
+
+/**
+ * @brief A layer, i.e. the unit the loader streams
+ *
+ */
+struct LayerInfo {
+  std::size_t offset = 0; /**< file offset, or offset in the uncompressed
+                             layout of a compressed container */
+  std::size_t size = 0;   /**< padded size in bytes, a multiple of alignment */
+  std::size_t dense_size = 0; /**< bytes before the first expert, size if the
+                                 layer has no experts */
+  std::vector<TensorInfo> tensors;
+  std::vector<ExpertInfo> experts;
+};
+
+/**
+ * @brief WeightsIndex describes where every layer and tensor lives in the
+ * weights file. It is either read from a container header or synthesized for
+ * a raw file of equally sized layers.
+ *
+ */
+class WeightsIndex {
+public:
+  static constexpr std::size_t DEFAULT_ALIGNMENT = 4096;
+  static constexpr std::size_t HUGE_ALIGNMENT = 2 * 1024 * 1024;
+
+  /**
+   * @brief Construct an empty index
+   *
+   * @param layer_alignment alignment of layer offsets and sizes, at least
+   * DEFAULT_ALIGNMENT
+   * @param tensor_alignment alignment of tensor offsets inside a layer
+   * @throws std::invalid_argument if an alignment is not a power of two, the
+   * layer alignment is below DEFAULT_ALIGNMENT or below the tensor alignment
+   */
+  explicit WeightsIndex(std::size_t layer_alignment = DEFAULT_ALIGNMENT,
+                        std::size_t tensor_alignment = DEFAULT_ALIGNMENT);
+
+  /**
+   * @brief Check whether the file starts with a container header
+   *
+   * @param fd file descriptor opened for reading
+   * @return true if the file is a container
+   */
+  static bool isContainer(int fd);
+
+  /**
+   * @brief Read the index of a container
+   *
+   * @param fd file descriptor opened for reading
+   * @return WeightsIndex index of the container
+   * @throws std::runtime_error if the header or index is malformed
+   */
+  static WeightsIndex read(int fd);
+
+  /**
+   * @brief Build the index of a raw file made of equally sized layers
+   *
+   * @param num_layers number of layers
+   * @param tensors tensors of every layer, as returned by decoderLayer()
+   * @return WeightsIndex index of the raw file
+   */
+  static WeightsIndex uniform(std::size_t num_layers,
+                              const std::vector<TensorInfo> &tensors);
+
+  /**
+   * @brief Tensors of one int4 decoder layer
+   *
+   * @param hidden hidden size
+   * @param kv_dim key/value projection size
+   * @param ffn feed-forward size
+   * @return std::vector<TensorInfo> tensors without offsets
+   */
+  static std::vector<TensorInfo> decoderLayer(std::uint32_t hidden,
+                                              std::uint32_t kv_dim,
+                                              std::uint32_t ffn);
+
+  /**
+   * @brief Tensors of one int4 mixture-of-experts decoder layer
+   *
+   * @param hidden hidden size
+   * @param kv_dim key/value projection size
+   * @param expert_ffn feed-forward size of a single expert
+   * @param num_experts number of experts
+   * @return std::vector<TensorInfo> tensors without offsets
+   */
+  static std::vector<TensorInfo> moeLayer(std::uint32_t hidden,
+                                          std::uint32_t kv_dim,
+                                          std::uint32_t expert_ffn,
+                                          std::uint32_t num_experts);
+
+  /**
+   * @brief Append a layer, assigning aligned offsets to it and its tensors
+   *
+   * @param tensors tensors of the layer; offsets and sizes are filled in
+   */
+  void addLayer(std::vector<TensorInfo> tensors);
+
+  /**
+   * @brief Split every layer into blocks that are compressed on their own,
+   * which turns the index into the one of a compressed container. Call it
+   * once all layers are added, then store every block with storeBlock().
+   *
+   * @param block_size largest uncompressed block, a multiple of
+   * DEFAULT_ALIGNMENT
+   * @throws std::invalid_argument if block_size is not page aligned
+   */
+  void splitBlocks(std::size_t block_size);
+
+  /**
+   * @brief Record how a block is stored. Blocks are stored in order, each at
+   * the next multiple of DEFAULT_ALIGNMENT after the one before it.
+   *
+   * @param block index of the block
+   * @param stored_size size of the stored block
+   * @param codec compression of the stored block
+   * @return std::size_t file offset to write the stored block to
+   */
+  std::size_t storeBlock(std::size_t block, std::size_t stored_size,
+                         BlockCodec codec);
+
+  /**
+   * @brief Check whether the layers are stored block compressed
+   *
+   * @return true for a compressed container
+   */
+  bool compressed() const { return !block_list.empty(); }
+
+  /**
+   * @brief Get the blocks of a compressed container
+   *
+   * @return const std::vector<BlockInfo>& blocks in layout order
+   */
+  const std::vector<BlockInfo> &blocks() const { return block_list; }
+
+  /**
+   * @brief Find the blocks that make up a range of the uncompressed layout
+   *
+   * @param offset start of the range
+   * @param length length of the range
+   * @return std::pair<std::size_t, std::size_t> first block and one past the
+   * last block of the range
+   * @throws std::invalid_argument if the range does not start and end on
+   * block boundaries
+   */
+  std::pair<std::size_t, std::size_t> blockRange(std::size_t offset,
+                                                 std::size_t length) const;
+
+  /**
+   * @brief Write the container header and index to the start of the file
+   *
+   * @param fd file descriptor opened for writing
+   * @throws std::runtime_error if writing fails
+   */
+  void write(int fd) const;
+
+  /**
+   * @brief Get the number of layers
+   *
+   * @return std::size_t number of layers
+   */
+  std::size_t numLayers() const { return layers.size(); }
+
+  /**
+   * @brief Get a layer
+   *
+   * @param layer_id layer id
+   * @return const LayerInfo& layer
+   */
+  const LayerInfo &layer(std::size_t layer_id) const {
+    return layers[layer_id];
+  }
+
+  /**
+   * @brief Get the size of the largest layer
+   *
+   * @return std::size_t size in bytes
+   */
+  std::size_t maxLayerSize() const;
+
+  /**
+   * @brief Get the size of the largest part of a layer shared by all tokens
+   *
+   * @return std::size_t size in bytes
+   */
+  std::size_t maxDenseSize() const;
+
+  /**
+   * @brief Get the size of the largest expert
+   *
+   * @return std::size_t size in bytes, 0 if no layer has experts
+   */
+  std::size_t maxExpertSize() const;
+
+  /**
+   * @brief Get the largest number of experts of a layer
+   *
+   * @return std::size_t number of experts, 0 for a dense model
+   */
+  std::size_t maxExperts() const;
+
+  /**
+   * @brief Get the total file size the index describes
+   *
+   * @return std::size_t end of the last layer, or of the last stored block
+   * rounded up to DEFAULT_ALIGNMENT for a compressed container
+   */
+  std::size_t fileSize() const;
+
+  /**
+   * @brief Get the alignment of layer offsets and sizes
+   *
+   * @return std::size_t alignment in bytes
+   */
+  std::size_t layerAlignment() const { return layer_alignment; }
+
+  /**
+   * @brief Get the alignment of tensor offsets inside a layer
+   *
+   * @return std::size_t alignment in bytes
+   */
+  std::size_t tensorAlignment() const { return tensor_alignment; }
+
+  /**
+   * @brief Check whether the index was read from a container header
+   *
+   * @return true if read from a container
+   */
+  bool fromContainer() const { return container; }
+
+private:
+  /**
+   * @brief Size of the header and index, rounded up to the layer alignment
+   *
+   * @return std::size_t offset of the first layer
+   */
+  std::size_t dataOffset() const;
+
+  /**
+   * @brief Place the layers one after the other behind the index
+   *
+   */
+  void placeLayers();
+
+  /**
+   * @brief Fill in dense_size and the expert ranges of a layer
+   *
+   * @param layer layer with its tensors and size set
+   * @throws std::invalid_argument if the experts are not numbered 0..N-1 or
+   * their tensors are not contiguous and after the shared ones
+   */
+  void layoutExperts(LayerInfo &layer) const;
+
+  std::size_t layer_alignment;
+  std::size_t tensor_alignment;
+  bool container = false;
+  std::vector<LayerInfo> layers;
+  std::vector<BlockInfo> block_list;
+};
+} // namespace nntrainer
+
+#endif // WEIGHTS_CONTAINER_HPP
@@ -0,0 +1,344 @@
+// SPDX-License-Identifier: Apache-2.0
+/**
+ * Copyright (C) 2026 Donghak Park <donghak.park@samsung.com>
+ *
+ * @file   weights_pack.cpp
+ * @date   16 Oct 2026
+ * @see    https://github.com/nnstreamer/nntrainer
+ * @author Donghak Park <donghak.park@samsung.com>
+ * @bug    No known bugs except for NYI items
+ * @brief  Writes a synthetic weights container with uneven layers
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <block_codec.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <weights_container.hpp>
+
+using nntrainer::BlockCodec;
+using nntrainer::DType;
+using nntrainer::TensorInfo;
+using nntrainer::WeightsIndex;
+
+constexpr std::uint32_t HIDDEN = 3072;
+constexpr std::uint32_t KV_DIM = 256;
+constexpr std::uint32_t FFN = 8192;
+constexpr std::uint32_t EXPERT_FFN = 2048;
+constexpr std::uint32_t VOCAB = 32000;
+constexpr size_t BLOCK_SIZE = 1024 * 1024;
+constexpr int DEFLATE_LEVEL = 1;
+// spread of int4 weights around their zero point, in quantization steps
+constexpr double Q4_SIGMA = 2.5;
+constexpr double GIB_MB = 1024.0;
+
+enum class Fill { NONE, RANDOM, Q4 };
+
+/**
+ * @brief Generate the data of a layer
+ *
+ * @param layer layer to generate
+ * @param fill what to fill it with, padding always stays zero
+ * @param rng random generator
+ * @param data receives layer.size bytes
+ */
+void fill_layer(const nntrainer::LayerInfo &layer, Fill fill,
+                std::mt19937_64 &rng, std::vector<char> &data) {
+  data.assign(layer.size, 0);
+  if (fill == Fill::RANDOM) {
+    for (size_t i = 0; i + 8 <= data.size(); i += 8) {
+      std::uint64_t word = rng();
+      std::memcpy(data.data() + i, &word, 8);
+    }
+    return;
+  }
+  if (fill != Fill::Q4)
+    return;
+
+  // nibbles of trained int4 weights are roughly normal around the zero
+  // point, 8 random bits pick one through the inverse distribution
+  static const std::vector<std::uint8_t> nibble = [] {
+    std::vector<std::uint8_t> table(256);
+    for (size_t u = 0; u < table.size(); ++u) {
+      double p = (u + 0.5) / table.size();
+      // the inverse of the normal CDF, by bisection
+      double z = 0.0, lo = -8.0 * Q4_SIGMA, hi = 8.0 * Q4_SIGMA;
+      for (int i = 0; i < 60; ++i) {
+        z = (lo + hi) / 2;
+        double cdf = 0.5 * std::erfc(-z / (Q4_SIGMA * std::sqrt(2.0)));
+        (cdf < p ? lo : hi) = z;
+      }
+      table[u] = static_cast<std::uint8_t>(
+        std::clamp<long>(std::lround(z) + 8, 0, 15));
+    }
+    return table;
+  }();
+
+  std::normal_distribution<float> norm(1.0f, 0.1f);
+  for (const auto &tensor : layer.tensors) {
+    char *dst = data.data() + tensor.offset;
+    if (tensor.dtype == DType::Q4) {
+      for (size_t i = 0; i < tensor.size; i += 4) {
+        std::uint64_t word = rng();
+        for (size_t b = i; b < std::min(i + 4, tensor.size); ++b) {
+          dst[b] = static_cast<char>(nibble[word & 0xFF] |
+                                     nibble[(word >> 8) & 0xFF] << 4);
+          word >>= 16;
+        }
+      }
+    } else if (tensor.dtype == DType::F32) {
+      for (size_t i = 0; i + 4 <= tensor.size; i += 4) {
+        float value = norm(rng);
+        std::memcpy(dst + i, &value, 4);
+      }
+    }
+  }
+}
+
+/**
+ * @brief What compressing the container cost and saved
+ *
+ */
+struct CompressionStats {
+  size_t raw_bytes = 0;
+  size_t stored_bytes = 0;
+  size_t stored_raw = 0; /**< blocks deflate could not shrink */
+  double deflate_ms = 0.0;
+  double inflate_ms = 0.0;
+};
+
+/**
+ * @brief Print the modelled load time of a GiB of weights from plain and
+ * compressed containers over a range of storage bandwidths
+ *
+ * @param stats measured compression
+ */
+void print_crossover(const CompressionStats &stats) {
+  double ratio = double(stats.stored_bytes) / stats.raw_bytes;
+  double raw_mb = stats.raw_bytes / (1024.0 * 1024.0);
+  double inflate_mbps = raw_mb / (stats.inflate_ms / 1000.0);
+  printf("Compression : %zu bytes stored as %zu (ratio %.3f), %zu bytes "
+         "kept uncompressed\n",
+         stats.raw_bytes, stats.stored_bytes, ratio, stats.stored_raw);
+  printf("Throughput : deflate %.0f MB/s, inflate %.0f MB/s of uncompressed "
+         "bytes per thread\n",
+         raw_mb / (stats.deflate_ms / 1000.0), inflate_mbps);
+
+  // a block task reads, then inflates; with several of them in flight the
+  // reads of some overlap the inflating of others, so a load takes the
+  // longer of the two. Without overlap it takes their sum
+  const unsigned int threads[] = {1, 2, 4, 8};
+  if (ratio >= 1.0)
+    printf("Crossover : nothing got smaller, compressed loads never win\n");
+  else
+    for (unsigned int t : threads)
+      printf("Crossover with %u inflating threads : compressed loads win "
+             "below %.0f MB/s of storage bandwidth (%.0f MB/s without "
+             "overlap)\n",
+             t, inflate_mbps * t, inflate_mbps * t * (1.0 - ratio));
+
+  printf("%12s %12s", "storage MB/s", "plain ms/GiB");
+  for (unsigned int t : threads)
+    printf(" %8s%-3u", "zip ms t=", t);
+  printf("\n");
+  for (double mbps : {100.0, 250.0, 500.0, 1000.0, 2000.0, 4000.0, 8000.0}) {
+    printf("%12.0f %12.1f", mbps, GIB_MB / mbps * 1000.0);
+    for (unsigned int t : threads)
+      printf(" %11.1f", std::max(ratio * GIB_MB / mbps,
+                                 GIB_MB / (inflate_mbps * t)) *
+                          1000.0);
+    printf("\n");
+  }
+}
+
+int main(int argc, char *argv[]) {
+  std::string output = "./weights.bin";
+  unsigned int decoder_layers = 32;
+  unsigned int num_experts = 0;
+  size_t alignment = WeightsIndex::DEFAULT_ALIGNMENT;
+  Fill fill = Fill::NONE;
+  bool compress = false;
+  int level = DEFLATE_LEVEL;
+  bool huffman_only = true;
+  size_t block_size = BLOCK_SIZE;
+  bool bench = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg.rfind("--layers=", 0) == 0) {
+      decoder_layers = std::stoul(arg.substr(strlen("--layers=")));
+    } else if (arg.rfind("--experts=", 0) == 0) {
+      num_experts = std::stoul(arg.substr(strlen("--experts=")));
+    } else if (arg.rfind("--align=", 0) == 0) {
+      alignment = std::stoul(arg.substr(strlen("--align=")));
+    } else if (arg == "--fill" || arg == "--fill=random") {
+      fill = Fill::RANDOM;
+    } else if (arg == "--fill=q4") {
+      fill = Fill::Q4;
+    } else if (arg == "--compress") {
+      compress = true;
+    } else if (arg.rfind("--compress=", 0) == 0) {
+      compress = true;
+      huffman_only = false;
+      level = std::clamp(std::stoi(arg.substr(strlen("--compress="))), 1, 9);
+    } else if (arg.rfind("--block-size=", 0) == 0) {
+      block_size = std::stoul(arg.substr(strlen("--block-size=")));
+    } else if (arg == "--bench") {
+      bench = true;
+    } else if (arg.rfind("--", 0) != 0) {
+      output = arg;
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [OUTPUT] [--layers=N] [--experts=N]"
+                << " [--align=4096|2097152] [--fill[=random|q4]]"
+                << " [--compress[=LEVEL]] [--block-size=BYTES] [--bench]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  if (alignment < WeightsIndex::DEFAULT_ALIGNMENT ||
+      (alignment & (alignment - 1)) != 0) {
+    std::cerr << "alignment must be a power of two of at least "
+              << WeightsIndex::DEFAULT_ALIGNMENT << std::endl;
+    return 1;
+  }
+
+  WeightsIndex index(alignment);
+  index.addLayer({{"tok_embd", DType::Q4, VOCAB, HIDDEN, 0, 0}});
+  for (unsigned int i = 0; i < decoder_layers; ++i) {
+    std::vector<TensorInfo> tensors = {
+      {"attn_norm", DType::F32, 1, HIDDEN, 0, 0},
+      {"ffn_norm", DType::F32, 1, HIDDEN, 0, 0}};
+    std::vector<TensorInfo> decoder =
+      num_experts > 0
+        ? WeightsIndex::moeLayer(HIDDEN, KV_DIM, EXPERT_FFN, num_experts)
+        : WeightsIndex::decoderLayer(HIDDEN, KV_DIM, FFN);
+    for (auto &tensor : decoder)
+      tensors.push_back(tensor);
+    index.addLayer(tensors);
+  }
+  index.addLayer({{"output_norm", DType::F32, 1, HIDDEN, 0, 0},
+                  {"lm_head", DType::Q4, VOCAB, HIDDEN, 0, 0}});
+
+  if (compress) {
+    try {
+      index.splitBlocks(block_size);
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  int fd = open(output.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+  if (fd < 0) {
+    std::cerr << "Failed to open " << output << " : " << strerror(errno)
+              << std::endl;
+    return 1;
+  }
+
+  // a compressed index only knows where its blocks go once they are stored,
+  // so it is written last
+  std::mt19937_64 rng(42);
+  std::vector<char> data;
+  std::vector<char> stored;
+  std::vector<char> check;
+  CompressionStats stats;
+  try {
+    if (!compress)
+      index.write(fd);
+    for (size_t l = 0; l < index.numLayers(); ++l) {
+      const nntrainer::LayerInfo &layer = index.layer(l);
+      if (fill == Fill::NONE && !compress)
+        continue;
+      fill_layer(layer, fill, rng, data);
+      if (!compress) {
+        if (pwrite(fd, data.data(), data.size(), layer.offset) !=
+            static_cast<ssize_t>(data.size()))
+          throw std::runtime_error("failed to fill " + output);
+        continue;
+      }
+
+      auto [first, last] = index.blockRange(layer.offset, layer.size);
+      for (size_t b = first; b < last; ++b) {
+        const nntrainer::BlockInfo &block = index.blocks()[b];
+        const char *src = data.data() + (block.offset - layer.offset);
+        auto start = std::chrono::steady_clock::now();
+        BlockCodec codec = nntrainer::compressBlock(
+          src, block.size, level, huffman_only, stored);
+        auto end = std::chrono::steady_clock::now();
+        size_t file_offset = index.storeBlock(b, stored.size(), codec);
+        if (pwrite(fd, stored.data(), stored.size(), file_offset) !=
+            static_cast<ssize_t>(stored.size()))
+          throw std::runtime_error("failed to write " + output);
+
+        stats.raw_bytes += block.size;
+        stats.stored_bytes += stored.size();
+        if (codec == BlockCodec::NONE)
+          stats.stored_raw += block.size;
+        stats.deflate_ms +=
+          std::chrono::duration<double, std::milli>(end - start).count();
+        if (!bench)
+          continue;
+
+        check.resize(block.size);
+        start = std::chrono::steady_clock::now();
+        bool ok = nntrainer::decompressBlock(block, stored.data(),
+                                             check.data());
+        end = std::chrono::steady_clock::now();
+        if (!ok || std::memcmp(check.data(), src, block.size) != 0)
+          throw std::runtime_error("block " + std::to_string(b) +
+                                   " does not survive a round trip");
+        stats.inflate_ms +=
+          std::chrono::duration<double, std::milli>(end - start).count();
+      }
+    }
+    if (compress)
+      index.write(fd);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    close(fd);
+    return 1;
+  }
+
+  if (ftruncate(fd, index.fileSize()) != 0) {
+    std::cerr << "Failed to size " << output << " : " << strerror(errno)
+              << std::endl;
+    close(fd);
+    return 1;
+  }
+  close(fd);
+
+  std::cout << "Wrote " << output << " : " << index.numLayers()
+            << " layers, " << index.fileSize() << " bytes, alignment "
+            << alignment << std::endl;
+  if (compress)
+    printf("Blocks : %zu of at most %zu bytes, deflate %s %d\n",
+           index.blocks().size(), block_size,
+           huffman_only ? "huffman only, level" : "level", level);
+  if (compress && bench && stats.raw_bytes > 0)
+    print_crossover(stats);
+  for (size_t l = 0; l < index.numLayers(); ++l) {
+    const nntrainer::LayerInfo &layer = index.layer(l);
+    std::cout << "  layer " << l << " @ " << layer.offset << " ("
+              << layer.size << " bytes)";
+    if (!layer.experts.empty()) {
+      std::cout << " " << layer.experts.size() << " experts of "
+                << layer.experts.front().size << " bytes" << std::endl;
+      continue;
+    }
+    for (const auto &tensor : layer.tensors)
+      std::cout << " " << tensor.name << ":" << nntrainer::dtypeName(tensor.dtype)
+                << "[" << tensor.rows << "x" << tensor.cols << "]";
+    std::cout << std::endl;
+  }
+  return 0;
+}